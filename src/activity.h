@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "common.h"
+#include "raylib.h"
+#include "raymath.h"
+
+// Margins around the visible area in unscaled map pixels. Entities overlapping the visible area update every frame,
+// the ones off screen but within the awake margin every `ACTIVITY_REDUCED_RATE_FRAMES` frames, everything further
+// sleeps.
+constexpr float const ACTIVITY_AWAKE_MARGIN{TILE_SIZE * 8};
+// Entities fall asleep a bit further out than they wake, so they do not flip on the border.
+constexpr float const ACTIVITY_SLEEP_MARGIN{ACTIVITY_AWAKE_MARGIN + TILE_SIZE * 2};
+constexpr int const ACTIVITY_REDUCED_RATE_FRAMES{4};
+// Spatial index bucket edge in unscaled map pixels.
+constexpr int const ACTIVITY_CELL_SIZE{TILE_SIZE * 8};
+
+/**
+ * Visible part of the map in scaled map pixels. There is no camera, the window shows the map from its origin.
+ */
+Rectangle screen_view() {
+  return Rectangle{0.f, 0.f, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight())};
+}
+
+enum class ActivityTier : uint8_t { Full, Reduced, Asleep };
+
+struct ActivityState {
+  ActivityTier tier{ActivityTier::Asleep};
+  int8_t frames_until_update{0};
+  // Time not yet simulated by reduced-rate updates.
+  float pending_delta{0.f};
+  IntVec2 cell{};
+};
+
+/**
+ * Decides which entities of a list update this frame. Everything on screen runs at full rate; only entities off screen
+ * are slowed down or put to sleep. Sleeping entities sit in a uniform grid and are only looked at when the visible area
+ * comes near their cell. Entities are identified by their index in the owner's list.
+ */
+struct ActivityScheduler {
+ public:
+  ActivityScheduler(int const pixel_size) : pixel_size(pixel_size) {
+  }
+
+  /**
+   * Starts over with `count` sleeping entities; `hitbox_of(i)` gives the hitbox of entity `i`.
+   */
+  template <typename H>
+  void reset(size_t count, H&& hitbox_of) {
+    states.assign(count, ActivityState{});
+    awake.clear();
+    due.clear();
+    buckets.clear();
+
+    for (size_t i = 0; i < count; i++) {
+      states[i].cell = cell_of(rect_center(hitbox_of(i)));
+      buckets[states[i].cell].push_back(i);
+    }
+  }
+
+  /**
+   * Wakes the entities near the visible area `view`, puts far ones to sleep and calls `update_entity(i)` for the ones
+   * due this frame. During the call `UpdateDeltaTime` is the time the entity has to advance.
+   */
+  template <typename H, typename U>
+  void update(Rectangle const& view, H&& hitbox_of, U&& update_entity) {
+    schedule(view, hitbox_of);
+    run_due(hitbox_of, update_entity);
+  }
+
+  /**
+   * First half of `update`: wakes and sleeps entities around `view` and collects the ones due this frame into
+   * `get_due`, so their inputs can be gathered in one pass before `run_due`.
+   */
+  template <typename H>
+  void schedule(Rectangle const& view, H&& hitbox_of) {
+    float const frame_time = GetFrameTime();
+
+    wake_near(view, hitbox_of);
+
+    due.clear();
+    for (size_t awake_index = 0; awake_index < awake.size();) {
+      size_t i = awake[awake_index];
+      ActivityState& state = states[i];
+
+      Rectangle const hitbox{hitbox_of(i)};
+      bool const is_visible = CheckCollisionRecs(hitbox, view);
+      if (!is_visible && distance_to_rect(rect_center(hitbox), view) > ACTIVITY_SLEEP_MARGIN * pixel_size) {
+        state.tier = ActivityTier::Asleep;
+        awake[awake_index] = awake.back();
+        awake.pop_back();
+        continue;
+      }
+      awake_index++;
+
+      state.tier = is_visible ? ActivityTier::Full : ActivityTier::Reduced;
+      state.pending_delta += frame_time;
+      if (state.tier == ActivityTier::Reduced && --state.frames_until_update > 0) continue;
+
+      due.push_back(i);
+    }
+  }
+
+  /**
+   * Second half of `update`: calls `update_entity(i)` for every entity in `get_due`.
+   */
+  template <typename H, typename U>
+  void run_due(H&& hitbox_of, U&& update_entity) {
+    for (size_t i : due) {
+      ActivityState& state = states[i];
+      UpdateDeltaTime = state.pending_delta;
+      update_entity(i);
+      state.pending_delta = 0.f;
+      state.frames_until_update = ACTIVITY_REDUCED_RATE_FRAMES;
+
+      move(i, cell_of(rect_center(hitbox_of(i))));
+    }
+
+    UpdateDeltaTime = GetFrameTime();
+  }
+
+  /**
+   * Indices of the entities `run_due` updates, valid after `schedule`.
+   */
+  std::vector<size_t> const& get_due() const {
+    return due;
+  }
+
+  /**
+   * Indices of the entities not asleep. Only these can be near the character.
+   */
+  std::vector<size_t> const& get_awake() const {
+    return awake;
+  }
+
+  ActivityTier tier(size_t i) const {
+    return states[i].tier;
+  }
+
+ private:
+  int const pixel_size;
+  std::vector<ActivityState> states{};
+  std::vector<size_t> awake{};
+  std::vector<size_t> due{};
+  std::unordered_map<IntVec2, std::vector<size_t>> buckets{};
+
+  IntVec2 cell_of(Vector2 const point) const {
+    float const cell_size = static_cast<float>(ACTIVITY_CELL_SIZE * pixel_size);
+    return IntVec2{static_cast<int>(floorf(point.x / cell_size)), static_cast<int>(floorf(point.y / cell_size))};
+  }
+
+  static float distance_to_rect(Vector2 const point, Rectangle const& rect) {
+    float const dx = std::max({rect.x - point.x, 0.f, point.x - (rect.x + rect.width)});
+    float const dy = std::max({rect.y - point.y, 0.f, point.y - (rect.y + rect.height)});
+    return sqrtf(dx * dx + dy * dy);
+  }
+
+  template <typename H>
+  void wake_near(Rectangle const& view, H&& hitbox_of) {
+    float const margin = ACTIVITY_AWAKE_MARGIN * pixel_size;
+    IntVec2 min_cell{cell_of(Vector2{view.x - margin, view.y - margin})};
+    IntVec2 max_cell{cell_of(Vector2{view.x + view.width + margin, view.y + view.height + margin})};
+
+    for (int y = min_cell.y; y <= max_cell.y; y++) {
+      for (int x = min_cell.x; x <= max_cell.x; x++) {
+        auto bucket_it = buckets.find(IntVec2{x, y});
+        if (bucket_it == buckets.end()) continue;
+
+        for (size_t i : bucket_it->second) {
+          ActivityState& state = states[i];
+          if (state.tier != ActivityTier::Asleep) continue;
+          Rectangle const hitbox{hitbox_of(i)};
+          if (!CheckCollisionRecs(hitbox, view) && distance_to_rect(rect_center(hitbox), view) > margin) continue;
+
+          // Time slept is dropped, not caught up.
+          state.tier = ActivityTier::Reduced;
+          state.pending_delta = 0.f;
+          state.frames_until_update = 0;
+          awake.push_back(i);
+        }
+      }
+    }
+  }
+
+  void move(size_t i, IntVec2 const cell) {
+    ActivityState& state = states[i];
+    if (state.cell == cell) return;
+
+    std::vector<size_t>& bucket = buckets[state.cell];
+    std::erase(bucket, i);
+    if (bucket.empty()) buckets.erase(state.cell);
+
+    state.cell = cell;
+    buckets[cell].push_back(i);
+  }
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "raylib.h"
+
+// Animation frames advance on a fixed clock, independently of the monitor refresh rate.
+constexpr int const AnimationFPS{24};
+constexpr float const AnimationTickLength{1.f / AnimationFPS};
+
+constexpr unsigned int const DEFAULT_FRAME_TICKS{1};
+
+struct AnimationListener {
+ public:
+  virtual ~AnimationListener() = default;
+
+  /**
+   * Called by the clock when a one-shot animation started with `tag` played its last frame.
+   */
+  virtual void on_animation_end(int tag) = 0;
+};
+
+/**
+ * Playback state of one sprite. The clock keeps all of them in one array, sprites hold an index into it.
+ */
+struct AnimationTrack {
+  uint32_t start_tick{0};
+  // Set by one-shot sequences: from this tick on the sequence rests on its first frame. 0 while looping.
+  uint32_t end_tick{0};
+  int16_t paused_frame{0};
+  // Frame seen by the last change check of the owner.
+  int16_t last_frame{0};
+  bool is_paused{false};
+};
+
+constexpr uint32_t const ANIMATION_TRACK_NONE{UINT32_MAX};
+
+struct AnimationEvent {
+  uint32_t tick;
+  AnimationListener* listener;
+  int tag;
+};
+
+/**
+ * Global animation tick and the playback state of every sprite. Frames are derived from the tick, so looping
+ * animations need no per-entity update. One-shot animations register their end tick here and get notified when it
+ * passes.
+ */
+struct AnimationClock {
+ public:
+  void update() {
+    elapsed += GetFrameTime();
+    while (elapsed >= AnimationTickLength) {
+      elapsed -= AnimationTickLength;
+      tick++;
+    }
+
+    fire_events();
+  }
+
+  uint32_t now() const {
+    return tick;
+  }
+
+  void schedule(uint32_t end_tick, AnimationListener* listener, int tag) {
+    cancel(listener, tag);
+    events.push_back(AnimationEvent{end_tick, listener, tag});
+  }
+
+  void cancel(AnimationListener* listener, int tag) {
+    std::erase_if(events, [&](auto const& event) { return event.listener == listener && event.tag == tag; });
+  }
+
+  void cancel(AnimationListener* listener) {
+    std::erase_if(events, [&](auto const& event) { return event.listener == listener; });
+  }
+
+  /**
+   * Index of a new track starting now. Slots of removed tracks are reused.
+   */
+  uint32_t add_track() {
+    AnimationTrack track{};
+    track.start_tick = tick;
+
+    if (!free_tracks.empty()) {
+      uint32_t index = free_tracks.back();
+      free_tracks.pop_back();
+      tracks[index] = track;
+      return index;
+    }
+
+    tracks.push_back(track);
+    return static_cast<uint32_t>(tracks.size() - 1);
+  }
+
+  void remove_track(uint32_t index) {
+    free_tracks.push_back(index);
+  }
+
+  // References are invalidated by `add_track`.
+  AnimationTrack& track(uint32_t index) {
+    return tracks[index];
+  }
+
+  AnimationTrack const& track(uint32_t index) const {
+    return tracks[index];
+  }
+
+  /**
+   * Frame of track `index` playing a sequence of `frame_count` frames, each `frame_length` ticks long.
+   */
+  int frame(uint32_t index, int frame_count, unsigned int frame_length) const {
+    AnimationTrack const& track = tracks[index];
+    if (track.is_paused) return track.paused_frame;
+    if (frame_count <= 1) return 0;
+    if (track.end_tick != 0 && tick >= track.end_tick) return 0;
+    return static_cast<int>(((tick - track.start_tick) / frame_length) % frame_count);
+  }
+
+ private:
+  uint32_t tick{0};
+  float elapsed{0.f};
+  std::vector<AnimationTrack> tracks{};
+  std::vector<uint32_t> free_tracks{};
+  std::vector<AnimationEvent> events{};
+  std::vector<AnimationEvent> fired_events{};
+
+  void fire_events() {
+    fired_events.clear();
+
+    for (size_t i = 0; i < events.size();) {
+      if (events[i].tick <= tick) {
+        fired_events.push_back(events[i]);
+        events[i] = events.back();
+        events.pop_back();
+      } else {
+        i++;
+      }
+    }
+
+    // Listeners may schedule new events from the callback.
+    for (auto const& event : fired_events) event.listener->on_animation_end(event.tag);
+  }
+};
+
+static AnimationClock animation_clock{};
+
+/**
+ * Owning index of a track of `animation_clock`. Copies get a track of their own with the same state.
+ */
+struct AnimationTrackHandle {
+ public:
+  AnimationTrackHandle() : index(animation_clock.add_track()) {
+  }
+
+  AnimationTrackHandle(AnimationTrackHandle const& other) : index(animation_clock.add_track()) {
+    animation_clock.track(index) = animation_clock.track(other.index);
+  }
+
+  AnimationTrackHandle(AnimationTrackHandle&& other) noexcept : index(other.index) {
+    other.index = ANIMATION_TRACK_NONE;
+  }
+
+  AnimationTrackHandle& operator=(AnimationTrackHandle const& other) {
+    if (this != &other) animation_clock.track(index) = animation_clock.track(other.index);
+    return *this;
+  }
+
+  AnimationTrackHandle& operator=(AnimationTrackHandle&& other) noexcept {
+    std::swap(index, other.index);
+    return *this;
+  }
+
+  ~AnimationTrackHandle() {
+    if (index != ANIMATION_TRACK_NONE) animation_clock.remove_track(index);
+  }
+
+  AnimationTrack& operator*() const {
+    return animation_clock.track(index);
+  }
+
+  AnimationTrack* operator->() const {
+    return &animation_clock.track(index);
+  }
+
+  uint32_t get_index() const {
+    return index;
+  }
+
+ private:
+  uint32_t index;
+};
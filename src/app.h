@@ -1,21 +1,36 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_set>
 #include <vector>
 
+#include "animation.h"
 #include "asset_manager.h"
+#include "campaign.h"
 #include "character.h"
+#include "file_watcher.h"
+#include "level.h"
+#include "level_textures.h"
 #include "map.h"
+#include "particles.h"
 #include "npc.h"
 #include "raylib.h"
+#include "rect_batch.h"
 #include "sprite.h"
 #include "sprite_group.h"
+#include "texture_reloader.h"
+#include "tile_factory.h"
 #include "trap.h"
 
 struct App {
  public:
   void init() {
-    SetTraceLogLevel(LOG_DEBUG);
+    logger.capture_trace_log();
+    logger.start();
 
     InitWindow(1024, 768, "Pupu");
 
@@ -23,10 +38,14 @@ struct App {
     FPSMultiplier = static_cast<float>(ReferenceFPS) / static_cast<float>(GameFPS);
     SetTargetFPS(GameFPS);
 
-    asset_manager.preload();
     character.init();
 
+    blueprint = campaign.start();
+    load_level();
     reset();
+
+    for (auto const& level_file : campaign.get_level_files()) map_watcher.watch(level_file);
+    texture_reloader.watch_all();
   }
 
   void run() {
@@ -53,85 +72,209 @@ struct App {
   Map map{DEFAULT_PIXEL_SIZE};
   int pixel_size{DEFAULT_PIXEL_SIZE};
   Character character{DEFAULT_PIXEL_SIZE};
-  std::vector<std::shared_ptr<Npc>> npcs{};
-  std::vector<std::shared_ptr<Trap>> traps{};
+  // Owns the npcs and traps of the current level.
+  Arena level_arena{};
+  // Transient buffers of one update, rewound at its start.
+  Arena frame_arena{ARENA_FRAME_BLOCK_SIZE};
+  std::vector<Npc*> npcs{};
+  std::vector<Trap*> traps{};
+  // Spawn tile (unscaled map pixels) of each npc and trap, same order as `npcs` and `traps`.
+  std::vector<IntVec2> npc_spawn_tiles{};
+  std::vector<IntVec2> trap_spawn_tiles{};
+  Campaign campaign{};
+  FileWatcher map_watcher{};
+  std::vector<std::string> changed_map_files{};
+  TextureReloader texture_reloader{};
+  LevelBlueprint blueprint{};
+  // Resident textures of the current level.
+  std::vector<int> level_textures{};
+  ActivityScheduler npc_activity{DEFAULT_PIXEL_SIZE};
+  ActivityScheduler trap_activity{DEFAULT_PIXEL_SIZE};
+  RectBatch npc_hitboxes{};
+  RectBatch trap_hitboxes{};
+  std::vector<uint64_t> collision_mask{};
 
   void reset() {
+    pause_update = false;
+
+    character.reset(blueprint.character_position.scale(pixel_size).to_vector2());
+    for (auto& npc : npcs) npc->reset();
+    for (auto& trap : traps) trap->reset();
+    map.restore();
+    particles.clear();
+    reset_activity();
+  }
+
+  /**
+   * Switches to the next level of the campaign. Its blueprint is already parsed, only the world is rebuilt. When the
+   * next map is broken the current level starts over instead.
+   */
+  void next_level() {
+    std::optional<LevelBlueprint> next_blueprint{campaign.advance()};
+    if (!next_blueprint.has_value()) {
+      reset();
+      return;
+    }
+
+    blueprint = std::move(*next_blueprint);
+    TraceLog(LOG_INFO, "Next level: %s", campaign.current_file().c_str());
+    load_level();
+    reset();
+  }
+
+  /**
+   * Puts every npc and trap to sleep at its current position. Call after the lists or positions changed.
+   */
+  void reset_activity() {
+    npc_activity.reset(npcs.size(), [&](size_t i) { return npcs[i]->hitbox(); });
+    trap_activity.reset(traps.size(), [&](size_t i) { return traps[i]->hitbox(); });
+  }
+
+  void load_level() {
+    set_level_textures(level_texture_names(blueprint));
+
     npcs.clear();
     traps.clear();
-    pause_update = false;
+    level_arena.reset();
+    npc_spawn_tiles.clear();
+    trap_spawn_tiles.clear();
 
-    reload_world_from_file();
+    SetWindowSize(blueprint.tile_width * TILE_SIZE * pixel_size, blueprint.tile_height * TILE_SIZE * pixel_size);
+
+    for (auto const& [tile_pos, tile_selection] : blueprint.tiles) spawn_entity(tile_pos, tile_selection);
+
+    map.reload_world(blueprint);
+  }
+
+  /**
+   * Loads the textures in `names` and evicts the ones only the previous level used.
+   */
+  void set_level_textures(std::vector<int> names) {
+    asset_manager.swap_resident_set(names, level_textures);
+    level_textures = std::move(names);
+  }
+
+  /**
+   * Creates the npc or trap of a map tile. Other tiles belong to the map.
+   */
+  void spawn_entity(IntVec2 const tile_pos, TileSelection const& tile_selection) {
+    TileFactory const& factory = tile_factory(tile_selection.source);
+
+    if (factory.make_npc) {
+      npcs.push_back(factory.make_npc(&level_arena, tile_pos, tile_selection.source, pixel_size));
+      npc_spawn_tiles.push_back(tile_pos);
+    }
+    if (factory.make_trap) {
+      traps.push_back(factory.make_trap(&level_arena, tile_pos, pixel_size));
+      trap_spawn_tiles.push_back(tile_pos);
+    }
   }
 
-  void reload_world_from_file() {
-    FILE* file = std::fopen("assets/maps/map.mp", "r");
-    if (!file) {
-      TraceLog(LOG_ERROR, "Cannot open map file");
-      exit(EXIT_FAILURE);
+  /**
+   * Applies the saved map to the running level. Tile edits are patched in place and everything else keeps its state;
+   * changes to the level size, background or interactive groups rebuild the level.
+   */
+  void hot_reload_level() {
+    std::optional<LevelBlueprint> parsed_blueprint{try_level_blueprint_from_file(campaign.current_file().c_str())};
+    if (!parsed_blueprint.has_value()) {
+      // Likely caught mid-write; the next change event reloads again.
+      TraceLog(LOG_WARNING, "Map reload failed, keeping the current level");
+      return;
     }
 
-    int background_index{};
-    int tiles_count{};
-    int tile_width{};
-    int tile_height{};
-
-    if (std::fread(&tile_width, sizeof(int), 1, file) != 1) BAIL;
-    if (std::fread(&tile_height, sizeof(int), 1, file) != 1) BAIL;
-    if (std::fread(&background_index, sizeof(int), 1, file) != 1) BAIL;
-    if (std::fread(&tiles_count, sizeof(int), 1, file) != 1) BAIL;
-
-    character.reset(intvec2_from_file(file).scale(pixel_size).to_vector2());
-
-    SetWindowSize(tile_width * TILE_SIZE * pixel_size, tile_height * TILE_SIZE * pixel_size);
-
-    std::unordered_map<IntVec2, TileSelection> map_tiles{};
-    for (int i = 0; i < tiles_count; i++) {
-      IntVec2 tile_pos = intvec2_from_file(file);
-      TileSelection tile_selection{tile_selection_from_file(file)};
-
-      switch (tile_selection.source) {
-        case TileSource::Gui:
-        case TileSource::Tileset:
-        case TileSource::Box1:
-        case TileSource::Box2:
-        case TileSource::Box3:
-        case TileSource::Trap5:
-          map_tiles[tile_pos] = tile_selection;
-          break;
-        case TileSource::Enemy1:
-        case TileSource::Enemy2:
-          npcs.push_back(std::make_shared<SimpleWalkNpc>(tile_pos, tile_selection.source, pixel_size));
-          break;
-        case TileSource::Enemy3:
-          npcs.push_back(std::make_shared<ChargingNpc>(tile_pos.scale(pixel_size).to_vector2(), pixel_size));
-          break;
-        case TileSource::Enemy4:
-          npcs.push_back(std::make_shared<ShootingNpc>(tile_pos.scale(pixel_size).to_vector2(), pixel_size));
-          break;
-        case TileSource::Enemy5:
-          npcs.push_back(std::make_shared<StompingNpc>(tile_pos.scale(pixel_size).to_vector2(), pixel_size));
-          break;
-        case TileSource::Trap1:
-          traps.push_back(std::make_shared<BouncingTrap>(tile_pos.scale(pixel_size).to_vector2(), pixel_size));
-          break;
-        case TileSource::Trap2:
-          traps.push_back(std::make_shared<CircleSawTrap>(tile_pos.scale(pixel_size).to_vector2(), pixel_size));
-          break;
-        case TileSource::Trap4:
-          traps.push_back(std::make_shared<SpikeTrap>(tile_pos.scale(pixel_size).to_vector2(), pixel_size));
-          break;
-        case TileSource::Trap6:
-          traps.push_back(std::make_shared<ShockTowerTrap>(tile_pos.scale(pixel_size).to_vector2(), pixel_size));
-          break;
-        default:
-          BAILF("Invalid: %d", tile_selection.source);
-      }
+    LevelBlueprint new_blueprint{std::move(*parsed_blueprint)};
+    std::vector<LevelTileChange> changes{level_blueprint_tile_changes(blueprint, new_blueprint)};
+
+    if (!can_patch_level(new_blueprint, changes)) {
+      TraceLog(LOG_INFO, "Map changed, rebuilding level");
+      blueprint = std::move(new_blueprint);
+      load_level();
+      reset();
+      return;
+    }
+
+    set_level_textures(level_texture_names(new_blueprint));
+    for (auto const& change : changes) {
+      if (change.before.has_value()) remove_tile(change.pos, *change.before);
+      if (change.after.has_value()) add_tile(change.pos, *change.after);
+    }
+
+    blueprint = std::move(new_blueprint);
+    reset_activity();
+    TraceLog(LOG_INFO, "Map changed, patched %zu tiles", changes.size());
+  }
+
+  bool can_patch_level(LevelBlueprint const& new_blueprint, std::vector<LevelTileChange> const& changes) const {
+    if (new_blueprint.tile_width != blueprint.tile_width || new_blueprint.tile_height != blueprint.tile_height ||
+        new_blueprint.background_index != blueprint.background_index ||
+        new_blueprint.interactive_groups != blueprint.interactive_groups) {
+      return false;
+    }
+
+    // Group tiles are baked into moving platforms.
+    std::unordered_set<IntVec2> group_tiles{};
+    for (auto const& group : blueprint.interactive_groups) {
+      for (auto const& elem_pos : group.get_elems()) group_tiles.insert(elem_pos);
+    }
+    for (auto const& change : changes) {
+      if (group_tiles.contains(change.pos)) return false;
+    }
+
+    return true;
+  }
+
+  void add_tile(IntVec2 const tile_pos, TileSelection const& tile_selection) {
+    switch (tile_kind(tile_selection.source).tile_class) {
+      case TileClass::Wall:
+        map.set_wall(IntVec2{tile_pos.x / TILE_SIZE, tile_pos.y / TILE_SIZE}, tile_selection);
+        break;
+      case TileClass::Box:
+        map.set_box(tile_pos, tile_selection);
+        break;
+      case TileClass::InteractiveObject:
+        map.add_disappearing_plank(tile_pos);
+        break;
+      case TileClass::Npc:
+        spawn_entity(tile_pos, tile_selection);
+        npcs.back()->reset();
+        break;
+      case TileClass::Trap:
+        spawn_entity(tile_pos, tile_selection);
+        traps.back()->reset();
+        break;
     }
+  }
+
+  void remove_tile(IntVec2 const tile_pos, TileSelection const& tile_selection) {
+    switch (tile_kind(tile_selection.source).tile_class) {
+      case TileClass::Wall:
+        map.remove_wall(IntVec2{tile_pos.x / TILE_SIZE, tile_pos.y / TILE_SIZE});
+        break;
+      case TileClass::Box:
+        map.remove_box(tile_pos);
+        break;
+      case TileClass::InteractiveObject:
+        map.remove_interactive_object(tile_pos);
+        break;
+      case TileClass::Npc:
+        remove_spawned(&npcs, &npc_spawn_tiles, tile_pos);
+        break;
+      case TileClass::Trap:
+        remove_spawned(&traps, &trap_spawn_tiles, tile_pos);
+        break;
+    }
+  }
 
-    std::fclose(file);
+  template <typename T>
+  void remove_spawned(std::vector<T*>* entities, std::vector<IntVec2>* spawn_tiles, IntVec2 const tile_pos) {
+    for (size_t i = 0; i < spawn_tiles->size(); i++) {
+      if (!((*spawn_tiles)[i] == tile_pos)) continue;
 
-    map.reload_world(background_index, tile_width, tile_height, std::move(map_tiles));
+      level_arena.destroy((*entities)[i]);
+      entities->erase(entities->begin() + i);
+      spawn_tiles->erase(spawn_tiles->begin() + i);
+      return;
+    }
   }
 
   void draw() const {
@@ -139,18 +282,51 @@ struct App {
     for (auto const& npc : npcs) npc->draw();
     for (auto const& trap : traps) trap->draw();
     character.draw();
+    particles.draw();
 
     DrawFPS(0, 0);
   }
 
   void update() {
+    frame_arena.reset();
+    changed_map_files.clear();
+    map_watcher.poll(&changed_map_files);
+    for (auto const& map_file : changed_map_files) {
+      if (map_file == campaign.current_file()) hot_reload_level();
+      // The next level may be the same file, e.g. a single level campaign.
+      campaign.on_level_file_changed(map_file);
+    }
+
+    if (texture_reloader.update()) map.rebake_background();
+
     if (!pause_update) {
+      animation_clock.update();
       map.update(character.hitbox());
-      for (auto& npc : npcs) npc->update(map, character);
-      for (auto& trap : traps) trap->update(map, character);
+      auto npc_hitbox_of = [&](size_t i) { return npcs[i]->hitbox(); };
+      Rectangle const view{screen_view()};
+      npc_activity.schedule(view, npc_hitbox_of);
+      // Platforms moved in `map.update`. Only awake npcs can be near the view.
+      for (size_t i : npc_activity.get_awake()) npcs[i]->displace(map.platform_carry(npcs[i]->hitbox()));
+      // Wall queries of all due npcs in one batch. No npc update changes the map.
+      std::vector<size_t> const& due_npcs = npc_activity.get_due();
+      std::span<Rectangle> npc_wall_queries{frame_arena.make_array<Rectangle>(due_npcs.size())};
+      std::span<WallBounds> npc_walls{frame_arena.make_array<WallBounds>(due_npcs.size())};
+      for (size_t k = 0; k < due_npcs.size(); k++) npc_wall_queries[k] = npcs[due_npcs[k]]->hitbox();
+      map.walls_of_ranges(npc_wall_queries, npc_walls);
+      size_t due_index{0};
+      npc_activity.run_due(npc_hitbox_of, [&](size_t i) { npcs[i]->update(map, character, npc_walls[due_index++]); });
+      trap_activity.update(
+          view, [&](size_t i) { return traps[i]->hitbox(); }, [&](size_t i) { traps[i]->update(map); });
+      // Traps act on the character before it moves, as they did when each trap update took the character.
+      update__trap_interactions();
       character.update(map);
 
       update__character_collisions();
+      particles.update(pixel_size);
+
+      if (std::any_of(traps.begin(), traps.end(), [](auto const& trap) { return trap->is_level_completed(); })) {
+        next_level();
+      }
     }
 
     if (IsKeyPressed(KEY_P)) pause_update = !pause_update;
@@ -159,22 +335,37 @@ struct App {
   }
 
   void update__character_collisions() {
-    for (auto& npc : npcs) {
-      Rectangle npc_hitbox{npc->hitbox()};
-      Rectangle character_hitbox{character.hitbox()};
-
-      if (CheckCollisionRecs(npc_hitbox, character_hitbox)) {
-        if (character.is_falling()) {
-          if (!npc->is_injured()) {
-            npc->injure();
-            character.enemy_head_bounce();
-          }
-        } else {
-          if (!npc->is_injured()) {
-            character.injure();
-          }
+    Rectangle const character_hitbox{character.hitbox()};
+
+    // Sleeping entities are far off screen, away from the character.
+    std::vector<size_t> const& awake_npcs = npc_activity.get_awake();
+    npc_hitboxes.clear();
+    for (size_t i : awake_npcs) npc_hitboxes.push(npcs[i]->hitbox());
+    overlap_one_to_many(character_hitbox, npc_hitboxes, &collision_mask);
+
+    for_each_mask_bit(collision_mask, npc_hitboxes.size(), [&](size_t i) {
+      auto& npc = npcs[awake_npcs[i]];
+
+      if (character.is_falling()) {
+        if (!npc->is_injured()) {
+          npc->injure();
+          character.enemy_head_bounce();
+        }
+      } else {
+        if (!npc->is_injured()) {
+          character.injure();
         }
       }
-    }
+    });
+  }
+
+  void update__trap_interactions() {
+    std::vector<size_t> const& awake_traps = trap_activity.get_awake();
+    trap_hitboxes.clear();
+    for (size_t i : awake_traps) trap_hitboxes.push(traps[i]->hitbox());
+    overlap_one_to_many(character.hitbox(), trap_hitboxes, &collision_mask);
+
+    for_each_mask_bit(collision_mask, trap_hitboxes.size(),
+                      [&](size_t i) { traps[awake_traps[i]]->interact(character); });
   }
 };
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+
+constexpr size_t const ARENA_DEFAULT_BLOCK_SIZE{64 * 1024};
+constexpr size_t const ARENA_FRAME_BLOCK_SIZE{16 * 1024};
+
+struct ArenaBlock {
+  std::unique_ptr<std::byte[]> data;
+  size_t size;
+};
+
+struct ArenaFinalizer {
+  // Address of the most derived object.
+  void* object;
+  void (*finalize)(void* object);
+};
+
+/**
+ * Bump allocator over a list of fixed blocks. Objects are destroyed and their memory is released all at once by
+ * `reset`, which keeps the blocks for the next round. After the first round no allocation reaches the heap unless the
+ * arena has to grow.
+ */
+struct Arena {
+ public:
+  explicit Arena(size_t const block_size = ARENA_DEFAULT_BLOCK_SIZE) : block_size(block_size) {
+  }
+
+  ~Arena() {
+    reset();
+  }
+
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  void* allocate(size_t const size, size_t const alignment) {
+    if (alignment > alignof(std::max_align_t)) BAILF("Unsupported alignment: %zu", alignment);
+
+    while (true) {
+      if (block_index < blocks.size()) {
+        ArenaBlock& block = blocks[block_index];
+        size_t offset = (block_offset + alignment - 1) & ~(alignment - 1);
+        if (offset + size <= block.size) {
+          block_offset = offset + size;
+          return block.data.get() + offset;
+        }
+
+        block_index++;
+        block_offset = 0;
+        continue;
+      }
+
+      size_t const new_block_size = std::max(block_size, size);
+      blocks.push_back(ArenaBlock{std::make_unique<std::byte[]>(new_block_size), new_block_size});
+    }
+  }
+
+  /**
+   * Constructs a `T` in the arena. It is destroyed by `reset`, or earlier by `destroy`.
+   */
+  template <typename T, typename... Args>
+  T* make(Args&&... args) {
+    T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      finalizers.push_back(ArenaFinalizer{object, [](void* p) { static_cast<T*>(p)->~T(); }});
+    }
+    return object;
+  }
+
+  /**
+   * `count` value-initialized elements, valid until `reset`.
+   */
+  template <typename T>
+  std::span<T> make_array(size_t const count) {
+    static_assert(std::is_trivially_destructible_v<T>);
+    T* items = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    std::uninitialized_value_construct_n(items, count);
+    return std::span<T>{items, count};
+  }
+
+  /**
+   * Destroys an object made by `make` before the next `reset`, through a pointer to it or to one of its bases. Its
+   * memory is only reused after `reset`.
+   */
+  template <typename T>
+  void destroy(T* object) {
+    void* address;
+    if constexpr (std::is_polymorphic_v<T>) {
+      address = dynamic_cast<void*>(object);
+    } else {
+      address = object;
+    }
+
+    auto it = std::find_if(finalizers.begin(), finalizers.end(),
+                           [address](ArenaFinalizer const& finalizer) { return finalizer.object == address; });
+    if (it == finalizers.end()) return;
+
+    it->finalize(it->object);
+    finalizers.erase(it);
+  }
+
+  /**
+   * Destroys every object, newest first, and rewinds to the first block.
+   */
+  void reset() {
+    for (auto it = finalizers.rbegin(); it != finalizers.rend(); it++) it->finalize(it->object);
+    finalizers.clear();
+    block_index = 0;
+    block_offset = 0;
+  }
+
+ private:
+  size_t const block_size;
+  std::vector<ArenaBlock> blocks{};
+  std::vector<ArenaFinalizer> finalizers{};
+  size_t block_index{0};
+  size_t block_offset{0};
+};
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <array>
 #include <memory>
-#include <unordered_map>
+#include <span>
+#include <vector>
 
+#include "asset_pack.h"
 #include "raylib.h"
+#include "texture_cache.h"
 
 constexpr int BACKGROUND_COUNT{6};
 
@@ -68,149 +72,184 @@ enum TextureNames {
   Trap5,
   Trap6__Example,
   Trap6,
+  End__Idle,
+  End__Pressed,
+
+  TextureNames__Count,
+};
+
+// Indexed by `TextureNames`.
+constexpr std::array<char const*, TextureNames__Count> const TEXTURE_PATHS{
+    "assets/craftpixnet/1 Main Characters/1/Run.png",            // Character1__Run
+    "assets/craftpixnet/1 Main Characters/1/Idle.png",           // Character1__Idle
+    "assets/craftpixnet/1 Main Characters/1/Hit.png",            // Character1__Hit
+    "assets/craftpixnet/1 Main Characters/1/Jump.png",           // Character1__Jump
+    "assets/craftpixnet/1 Main Characters/1/Fall.png",           // Character1__Fall
+    "assets/craftpixnet/1 Main Characters/1/Double_Jump.png",    // Character1__Double_Jump
+    "assets/craftpixnet/1 Main Characters/1/Wall_Jump.png",      // Character1__Wall_Jump
+    "assets/craftpixnet/1 Main Characters/1/Example.png",        // Character1__Example
+    "assets/craftpixnet/1 Main Characters/Appearing.png",        // Character__Appear
+    "assets/craftpixnet/1 Main Characters/Disappearing.png",     // Character__Disappear
+    "assets/craftpixnet/7 Levels/Tiled/Backgrounds/1.png",       // Background__0
+    "assets/craftpixnet/7 Levels/Tiled/Backgrounds/2.png",       // Background__1
+    "assets/craftpixnet/7 Levels/Tiled/Backgrounds/3.png",       // Background__2
+    "assets/craftpixnet/7 Levels/Tiled/Backgrounds/4.png",       // Background__3
+    "assets/craftpixnet/7 Levels/Tiled/Backgrounds/5.png",       // Background__4
+    "assets/craftpixnet/7 Levels/Tiled/Backgrounds/6.png",       // Background__5
+    "assets/craftpixnet/7 Levels/Tiled/GUI.png",                 // GuiTiles
+    "assets/craftpixnet/7 Levels/Tiled/Tileset.png",             // TilesetTiles
+    "assets/craftpixnet/3 Objects/Boxes/1_Idle.png",             // Box1__Idle
+    "assets/craftpixnet/3 Objects/Boxes/2_Idle.png",             // Box2__Idle
+    "assets/craftpixnet/3 Objects/Boxes/3_Idle.png",             // Box3__Idle
+    "assets/craftpixnet/4 Enemies/1/Example.png",                // Enemy1__Example
+    "assets/craftpixnet/4 Enemies/1/Fall.png",                   // Enemy1__Fall
+    "assets/craftpixnet/4 Enemies/1/Hit.png",                    // Enemy1__Hit
+    "assets/craftpixnet/4 Enemies/1/Idle.png",                   // Enemy1__Idle
+    "assets/craftpixnet/4 Enemies/1/Jump.png",                   // Enemy1__Jump
+    "assets/craftpixnet/4 Enemies/1/Run.png",                    // Enemy1__Run
+    "assets/craftpixnet/4 Enemies/2/Fall.png",                   // Enemy2__Fall
+    "assets/craftpixnet/4 Enemies/2/Hit.png",                    // Enemy2__Hit
+    "assets/craftpixnet/4 Enemies/2/Idle.png",                   // Enemy2__Idle
+    "assets/craftpixnet/4 Enemies/2/Jump.png",                   // Enemy2__Jump
+    "assets/craftpixnet/4 Enemies/2/Run.png",                    // Enemy2__Run
+    "assets/craftpixnet/4 Enemies/3/Example.png",                // Enemy3__Example
+    "assets/craftpixnet/4 Enemies/3/Charge.png",                 // Enemy3__Charge
+    "assets/craftpixnet/4 Enemies/3/Hit.png",                    // Enemy3__Hit
+    "assets/craftpixnet/4 Enemies/3/Idle.png",                   // Enemy3__Idle
+    "assets/craftpixnet/4 Enemies/3/Stun.png",                   // Enemy3__Stun
+    "assets/craftpixnet/4 Enemies/3/Walk.png",                   // Enemy3__Walk
+    "assets/craftpixnet/4 Enemies/4/Example.png",                // Enemy4__Example
+    "assets/craftpixnet/4 Enemies/4/Attack.png",                 // Enemy4__Attack
+    "assets/craftpixnet/4 Enemies/4/Hit.png",                    // Enemy4__Hit
+    "assets/craftpixnet/4 Enemies/4/Idle.png",                   // Enemy4__Idle
+    "assets/craftpixnet/4 Enemies/4/Walk.png",                   // Enemy4__Walk
+    "assets/craftpixnet/4 Enemies/5/Example.png",                // Enemy5__Example
+    "assets/craftpixnet/4 Enemies/5/Attack.png",                 // Enemy5__Attack
+    "assets/craftpixnet/4 Enemies/5/Fly.png",                    // Enemy5__Fly
+    "assets/craftpixnet/4 Enemies/5/Hit.png",                    // Enemy5__Hit
+    "assets/craftpixnet/4 Enemies/5/Idle.png",                   // Enemy5__Idle
+    "assets/craftpixnet/4 Enemies/4/Cannonball1.png",            // BulletShort
+    "assets/craftpixnet/4 Enemies/4/Cannonball2.png",            // BulletLong
+    "assets/craftpixnet/6 Traps/1_Example.png",                  // Trap1__Example
+    "assets/craftpixnet/6 Traps/1.png",                          // Trap1
+    "assets/craftpixnet/6 Traps/2_Example.png",                  // Trap2__Example
+    "assets/craftpixnet/6 Traps/2.png",                          // Trap2
+    "assets/craftpixnet/6 Traps/4_Example.png",                  // Trap4__Example
+    "assets/craftpixnet/6 Traps/4.png",                          // Trap4
+    "assets/craftpixnet/6 Traps/5_Example.png",                  // Trap5__Example
+    "assets/craftpixnet/6 Traps/5.png",                          // Trap5
+    "assets/craftpixnet/6 Traps/6_Example.png",                  // Trap6__Example
+    "assets/craftpixnet/6 Traps/6.png",                          // Trap6
+    "assets/craftpixnet/3 Objects/Checkpoints/End_Idle.png",     // End__Idle
+    "assets/craftpixnet/3 Objects/Checkpoints/End_Pressed.png",  // End__Pressed
 };
 
+/**
+ * Owns the textures. Handles in `textures` exist for every name all the time, a texture is resident (uploaded) only
+ * while it is acquired at least once.
+ */
 struct AssetManager {
  public:
-  std::unordered_map<int, std::shared_ptr<Texture2D>> textures{};
+  // Indexed by `TextureNames`.
+  std::array<std::shared_ptr<Texture2D>, TextureNames__Count> textures{};
+
+  AssetManager() {
+    for (auto& texture : textures) texture = std::make_shared<Texture2D>();
+  }
 
   // Must be the last thing called.
   void unload_assets() {
     TraceLog(LOG_INFO, "Unload all textures");
 
-    for (auto [k, v] : textures) UnloadTexture(*v);
+    for (int i = 0; i < TextureNames__Count; i++) {
+      if (ref_counts[i] > 0) unload_texture(i);
+      ref_counts[i] = 0;
+    }
   }
 
+  /**
+   * Makes every texture resident, for tools that show all of them.
+   */
   void preload() {
-    textures[TextureNames::Character1__Run] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/1/Run.png"));
-    textures[TextureNames::Character1__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/1/Idle.png"));
-    textures[TextureNames::Character1__Hit] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/1/Hit.png"));
-    textures[TextureNames::Character1__Jump] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/1/Jump.png"));
-    textures[TextureNames::Character1__Fall] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/1/Fall.png"));
-    textures[TextureNames::Character1__Double_Jump] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/1/Double_Jump.png"));
-    textures[TextureNames::Character1__Wall_Jump] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/1/Wall_Jump.png"));
-    textures[TextureNames::Character1__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/1/Example.png"));
-
-    textures[TextureNames::Character__Appear] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/Appearing.png"));
-    textures[TextureNames::Character__Disappear] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/1 Main Characters/Disappearing.png"));
-
-    textures[TextureNames::Background__0] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/7 Levels/Tiled/Backgrounds/1.png"));
-    textures[TextureNames::Background__1] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/7 Levels/Tiled/Backgrounds/2.png"));
-    textures[TextureNames::Background__2] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/7 Levels/Tiled/Backgrounds/3.png"));
-    textures[TextureNames::Background__3] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/7 Levels/Tiled/Backgrounds/4.png"));
-    textures[TextureNames::Background__4] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/7 Levels/Tiled/Backgrounds/5.png"));
-    textures[TextureNames::Background__5] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/7 Levels/Tiled/Backgrounds/6.png"));
-
-    textures[TextureNames::GuiTiles] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/7 Levels/Tiled/GUI.png"));
-    textures[TextureNames::TilesetTiles] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/7 Levels/Tiled/Tileset.png"));
-
-    textures[TextureNames::Box1__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/3 Objects/Boxes/1_Idle.png"));
-    textures[TextureNames::Box2__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/3 Objects/Boxes/2_Idle.png"));
-    textures[TextureNames::Box3__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/3 Objects/Boxes/3_Idle.png"));
-
-    textures[TextureNames::Enemy1__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/1/Example.png"));
-    textures[TextureNames::Enemy1__Fall] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/1/Fall.png"));
-    textures[TextureNames::Enemy1__Hit] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/1/Hit.png"));
-    textures[TextureNames::Enemy1__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/1/Idle.png"));
-    textures[TextureNames::Enemy1__Jump] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/1/Jump.png"));
-    textures[TextureNames::Enemy1__Run] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/1/Run.png"));
-
-    textures[TextureNames::Enemy2__Fall] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/2/Fall.png"));
-    textures[TextureNames::Enemy2__Hit] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/2/Hit.png"));
-    textures[TextureNames::Enemy2__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/2/Idle.png"));
-    textures[TextureNames::Enemy2__Jump] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/2/Jump.png"));
-    textures[TextureNames::Enemy2__Run] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/2/Run.png"));
-
-    textures[TextureNames::Enemy3__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/3/Example.png"));
-    textures[TextureNames::Enemy3__Charge] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/3/Charge.png"));
-    textures[TextureNames::Enemy3__Hit] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/3/Hit.png"));
-    textures[TextureNames::Enemy3__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/3/Idle.png"));
-    textures[TextureNames::Enemy3__Stun] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/3/Stun.png"));
-    textures[TextureNames::Enemy3__Walk] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/3/Walk.png"));
-
-    textures[TextureNames::Enemy4__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/4/Example.png"));
-    textures[TextureNames::Enemy4__Attack] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/4/Attack.png"));
-    textures[TextureNames::Enemy4__Hit] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/4/Hit.png"));
-    textures[TextureNames::Enemy4__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/4/Idle.png"));
-    textures[TextureNames::Enemy4__Walk] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/4/Walk.png"));
-
-    textures[TextureNames::BulletShort] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/4/Cannonball1.png"));
-    textures[TextureNames::BulletLong] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/4/Cannonball2.png"));
-
-    textures[TextureNames::Enemy5__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/5/Example.png"));
-    textures[TextureNames::Enemy5__Attack] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/5/Attack.png"));
-    textures[TextureNames::Enemy5__Fly] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/5/Fly.png"));
-    textures[TextureNames::Enemy5__Hit] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/5/Hit.png"));
-    textures[TextureNames::Enemy5__Idle] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/4 Enemies/5/Idle.png"));
-
-    textures[TextureNames::Trap1__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/1_Example.png"));
-    textures[TextureNames::Trap1] = std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/1.png"));
-    textures[TextureNames::Trap2__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/2_Example.png"));
-    textures[TextureNames::Trap2] = std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/2.png"));
-    textures[TextureNames::Trap4__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/4_Example.png"));
-    textures[TextureNames::Trap4] = std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/4.png"));
-    textures[TextureNames::Trap5__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/5_Example.png"));
-    textures[TextureNames::Trap5] = std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/5.png"));
-    textures[TextureNames::Trap6__Example] =
-        std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/6_Example.png"));
-    textures[TextureNames::Trap6] = std::make_shared<Texture2D>(LoadTexture("assets/craftpixnet/6 Traps/6.png"));
+    for (int i = 0; i < TextureNames__Count; i++) acquire(i);
+  }
+
+  void acquire(int name) {
+    if (ref_counts[name]++ == 0) load_texture(name);
+  }
+
+  void release(int name) {
+    if (ref_counts[name] <= 0) {
+      TraceLog(LOG_WARNING, "Texture released more than acquired: %s", TEXTURE_PATHS[name]);
+      return;
+    }
+
+    if (--ref_counts[name] == 0) unload_texture(name);
+  }
+
+  /**
+   * Acquires `names` then releases `old_names`, so textures in both stay resident.
+   */
+  void swap_resident_set(std::vector<int> const& names, std::vector<int> const& old_names) {
+    for (int name : names) acquire(name);
+    for (int name : old_names) release(name);
+  }
+
+  bool is_resident(int name) const {
+    return ref_counts[name] > 0;
+  }
+
+  /**
+   * Replaces the GPU texture behind the existing handle, so every holder sees the new one.
+   */
+  void replace_texture(int name, Image const& image) {
+    // Evicted since, the next load reads the new file.
+    if (!is_resident(name)) return;
+
+    Texture2D texture = LoadTextureFromImage(image);
+    if (texture.id == 0) {
+      TraceLog(LOG_WARNING, "Cannot upload reloaded texture: %s", TEXTURE_PATHS[name]);
+      return;
+    }
+
+    UnloadTexture(*textures[name]);
+    *textures[name] = texture;
+    TraceLog(LOG_INFO, "Reloaded texture: %s", TEXTURE_PATHS[name]);
   }
 
  private:
+  std::array<int, TextureNames__Count> ref_counts{};
+  // Opened on the first load, stays mapped so later loads are served from it too.
+  AssetPack pack{};
+  bool is_pack_checked{false};
+
+  /**
+   * Loads from the asset pack when there is one (see `make pack`), otherwise from the loose file. Entries older than
+   * their loose file are skipped, so edited images show up without repacking.
+   */
+  void load_texture(int name) {
+    if (!is_pack_checked) {
+      pack.open(ASSET_PACK_FILE, TextureNames__Count);
+      is_pack_checked = true;
+    }
+
+    bool is_pack_current = pack.is_open() && pack.is_entry_current(name, TEXTURE_PATHS[name]);
+    if (pack.is_open() && !is_pack_current) {
+      TraceLog(LOG_WARNING, "Asset pack entry is stale, loading the loose file: %s", TEXTURE_PATHS[name]);
+    }
+
+    if (is_pack_current) {
+      std::span<unsigned char const> data{pack.entry(name)};
+      *textures[name] = load_texture_cached(TEXTURE_PATHS[name], data.data(), static_cast<int>(data.size()));
+    } else {
+      *textures[name] = load_texture_cached(TEXTURE_PATHS[name]);
+    }
+  }
+
+  void unload_texture(int name) {
+    UnloadTexture(*textures[name]);
+    *textures[name] = Texture2D{};
+  }
 };
 
 static AssetManager asset_manager{};
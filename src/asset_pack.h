@@ -0,0 +1,156 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "raylib.h"
+
+constexpr const char* ASSET_PACK_FILE{"assets/assets.pack"};
+constexpr uint32_t const ASSET_PACK_MAGIC{0x4b505550};  // "PUPK"
+constexpr uint32_t const ASSET_PACK_VERSION{2};
+
+/**
+ * Pack layout: this header, `entry_count` entries, then the file contents the entries point at.
+ */
+struct AssetPackHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t padding;
+};
+
+struct AssetPackEntry {
+  // From the start of the pack.
+  uint64_t offset;
+  uint64_t size;
+  // Size and modification time (seconds) of the loose file when it was packed.
+  uint64_t source_size;
+  int64_t source_mtime;
+};
+
+/**
+ * Size and modification time of the file at `path`. False if it cannot be stat'ed.
+ */
+bool asset_source_stat(const char* path, uint64_t* size, int64_t* mtime) {
+  struct stat file_stat {};
+  if (stat(path, &file_stat) != 0) return false;
+
+  *size = static_cast<uint64_t>(file_stat.st_size);
+  *mtime = static_cast<int64_t>(file_stat.st_mtime);
+  return true;
+}
+
+/**
+ * Read-only view of an asset pack. The whole pack is mapped once, entries are served from the mapping without copies.
+ */
+struct AssetPack {
+ public:
+  AssetPack() = default;
+
+  ~AssetPack() {
+    close_pack();
+  }
+
+  AssetPack(AssetPack const&) = delete;
+  AssetPack& operator=(AssetPack const&) = delete;
+
+  /**
+   * Maps `filename`. Fails if it is missing, malformed or has not exactly `expected_entry_count` entries.
+   */
+  bool open(const char* filename, uint32_t expected_entry_count) {
+    close_pack();
+
+    int fd = ::open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(AssetPackHeader)) {
+      ::close(fd);
+      return false;
+    }
+
+    mapped_size = static_cast<size_t>(file_stat.st_size);
+    void* mapping = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+      mapped_size = 0;
+      return false;
+    }
+    mapped = static_cast<unsigned char const*>(mapping);
+
+    if (!validate(expected_entry_count)) {
+      TraceLog(LOG_WARNING, "Invalid asset pack: %s", filename);
+      close_pack();
+      return false;
+    }
+
+    TraceLog(LOG_INFO, "Asset pack opened: %s", filename);
+    return true;
+  }
+
+  bool is_open() const {
+    return mapped != nullptr;
+  }
+
+  std::span<unsigned char const> entry(uint32_t index) const {
+    if (index >= entry_count) return {};
+
+    AssetPackEntry pack_entry{entry_at(index)};
+    return std::span<unsigned char const>{mapped + pack_entry.offset, static_cast<size_t>(pack_entry.size)};
+  }
+
+  /**
+   * Whether entry `index` still matches the loose file it was packed from. A pack shipped without the loose files is
+   * always current.
+   */
+  bool is_entry_current(uint32_t index, const char* source_path) const {
+    if (index >= entry_count) return false;
+
+    uint64_t source_size{};
+    int64_t source_mtime{};
+    if (!asset_source_stat(source_path, &source_size, &source_mtime)) return true;
+
+    AssetPackEntry pack_entry{entry_at(index)};
+    return pack_entry.source_size == source_size && pack_entry.source_mtime == source_mtime;
+  }
+
+ private:
+  unsigned char const* mapped{nullptr};
+  size_t mapped_size{0};
+  uint32_t entry_count{0};
+
+  AssetPackEntry entry_at(uint32_t index) const {
+    AssetPackEntry pack_entry{};
+    std::memcpy(&pack_entry, mapped + sizeof(AssetPackHeader) + index * sizeof(AssetPackEntry), sizeof(pack_entry));
+    return pack_entry;
+  }
+
+  bool validate(uint32_t expected_entry_count) {
+    AssetPackHeader header{};
+    std::memcpy(&header, mapped, sizeof(header));
+
+    if (header.magic != ASSET_PACK_MAGIC || header.version != ASSET_PACK_VERSION) return false;
+    if (header.entry_count != expected_entry_count) return false;
+    if (mapped_size < sizeof(AssetPackHeader) + header.entry_count * sizeof(AssetPackEntry)) return false;
+
+    entry_count = header.entry_count;
+    for (uint32_t i = 0; i < entry_count; i++) {
+      AssetPackEntry pack_entry{entry_at(i)};
+      if (pack_entry.offset > mapped_size || pack_entry.size > mapped_size - pack_entry.offset) return false;
+    }
+    return true;
+  }
+
+  void close_pack() {
+    if (mapped) munmap(const_cast<unsigned char*>(mapped), mapped_size);
+    mapped = nullptr;
+    mapped_size = 0;
+    entry_count = 0;
+  }
+};
@@ -0,0 +1,54 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "asset_manager.h"
+#include "asset_pack.h"
+#include "file_util.h"
+#include "raylib.h"
+
+/**
+ * Builds the asset pack from the loose texture files, in `TextureNames` order.
+ *
+ * Usage: asset_packer [OUTPUT]
+ */
+int main(int argc, char** argv) {
+  const char* output_filename = argc > 1 ? argv[1] : ASSET_PACK_FILE;
+
+  AssetPackHeader header{ASSET_PACK_MAGIC, ASSET_PACK_VERSION, TextureNames__Count, 0};
+  std::vector<AssetPackEntry> entries(TextureNames__Count);
+  std::vector<char> data{};
+
+  uint64_t data_offset = sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry);
+  for (int i = 0; i < TextureNames__Count; i++) {
+    int file_size{0};
+    unsigned char* file_data = LoadFileData(TEXTURE_PATHS[i], &file_size);
+    if (!file_data) {
+      TraceLog(LOG_ERROR, "Cannot read: %s", TEXTURE_PATHS[i]);
+      return EXIT_FAILURE;
+    }
+
+    uint64_t source_size{};
+    int64_t source_mtime{};
+    if (!asset_source_stat(TEXTURE_PATHS[i], &source_size, &source_mtime)) {
+      TraceLog(LOG_ERROR, "Cannot stat: %s", TEXTURE_PATHS[i]);
+      UnloadFileData(file_data);
+      return EXIT_FAILURE;
+    }
+
+    entries[i] = AssetPackEntry{data_offset + data.size(), static_cast<uint64_t>(file_size), source_size, source_mtime};
+    data.insert(data.end(), file_data, file_data + file_size);
+    UnloadFileData(file_data);
+  }
+
+  std::vector<char> buffer(data_offset);
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  std::memcpy(buffer.data() + sizeof(header), entries.data(), entries.size() * sizeof(AssetPackEntry));
+  buffer.insert(buffer.end(), data.begin(), data.end());
+
+  if (!write_file_atomically(output_filename, buffer)) return EXIT_FAILURE;
+
+  TraceLog(LOG_INFO, "Packed %d textures (%zu bytes) into %s", TextureNames__Count, buffer.size(), output_filename);
+  return EXIT_SUCCESS;
+}
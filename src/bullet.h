@@ -2,18 +2,19 @@
 
 #include "asset_manager.h"
 #include "common.h"
+#include "particles.h"
 #include "raylib.h"
 #include "sprite_group.h"
 
 struct Bullet {
  public:
   Bullet(Vector2 const pos, int const pixel_size, float const speed, int const west_wall, int const east_wall)
-      : pos(pos), pixel_size(pixel_size), speed(speed), west_wall(west_wall), east_wall(east_wall) {
-    sprite_group.push_sprite(
-        Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::BulletShort],
-               Vector2{static_cast<float>(asset_manager.textures[TextureNames::BulletShort]->width),
-                       static_cast<float>(asset_manager.textures[TextureNames::BulletShort]->height)},
-               1, 0});
+      : pos(pos),
+        pixel_size(pixel_size),
+        speed(speed),
+        sprite_group(AnimationPrototype::BulletShort, static_cast<float>(pixel_size)),
+        west_wall(west_wall),
+        east_wall(east_wall) {
   }
 
   void draw() const {
@@ -21,8 +22,7 @@ struct Bullet {
   }
 
   void update() {
-    sprite_group.update();
-    pos.x += speed * GetFrameTime();
+    pos.x += speed * UpdateDeltaTime;
   }
 
   bool is_dead() const {
@@ -30,19 +30,24 @@ struct Bullet {
   }
 
   Rectangle hitbox() const {
-    std::shared_ptr<Texture2D> const texture = sprite_group.current_sprite().get_texture();
-    return Rectangle{pos.x, pos.y, static_cast<float>(texture->width), static_cast<float>(texture->height)};
+    Vector2 const size{sprite_group.current_sheet().size};
+    return Rectangle{pos.x, pos.y, size.x, size.y};
   }
 
   void set_target_hit() {
+    if (!target_hit) emit_impact();
     target_hit = true;
   }
 
+  void emit_impact() const {
+    particles.emit(ParticleBurstBulletImpact, rect_center(hitbox()), pixel_size);
+  }
+
  private:
   Vector2 pos;
   int const pixel_size;
   float const speed;
-  SpriteGroup sprite_group{};
+  SpriteGroup sprite_group;
   int const west_wall;
   int const east_wall;
   bool target_hit{false};
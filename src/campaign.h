@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "level.h"
+#include "raylib.h"
+
+constexpr const char* CAMPAIGN_FILE{"assets/maps/campaign.txt"};
+
+/**
+ * Map files of the campaign in play order: one path per line, blank lines and `#` comments skipped. Without a campaign
+ * file the game is the single default map.
+ */
+std::vector<std::string> campaign_level_files_from_file(const char* filename) {
+  std::vector<std::string> level_files{};
+
+  FILE* file = std::fopen(filename, "r");
+  if (!file) {
+    TraceLog(LOG_INFO, "No campaign file, playing %s", DEFAULT_MAP_FILE);
+    level_files.emplace_back(DEFAULT_MAP_FILE);
+    return level_files;
+  }
+
+  char line[512];
+  while (std::fgets(line, sizeof(line), file)) {
+    line[std::strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '\0' || line[0] == '#') continue;
+    level_files.emplace_back(line);
+  }
+  std::fclose(file);
+
+  if (level_files.empty()) BAILF("Empty campaign: %s", filename);
+  for (auto const& level_file : level_files) {
+    if (!FileExists(level_file.c_str())) BAILF("Missing campaign level: %s", level_file.c_str());
+  }
+  return level_files;
+}
+
+/**
+ * Level sequence of the game. While a level is played the next one is parsed on a worker thread, so advancing is
+ * a swap. The campaign starts over after the last level. A failed preload never ends the game, it is reported by
+ * `advance`.
+ */
+struct Campaign {
+ public:
+  Campaign() : level_files(campaign_level_files_from_file(CAMPAIGN_FILE)) {
+  }
+
+  /**
+   * Parses the first level and starts preloading the second.
+   */
+  LevelBlueprint start() {
+    current = 0;
+    LevelBlueprint blueprint{level_blueprint_from_file(level_files[current].c_str())};
+    preload_next();
+    return blueprint;
+  }
+
+  /**
+   * Moves to the next level. Only blocks when its preload has not finished yet. Empty when the next map could not be
+   * parsed; the campaign then stays on the current level and parses the next one again.
+   */
+  std::optional<LevelBlueprint> advance() {
+    std::optional<LevelBlueprint> blueprint{next_blueprint.get()};
+    if (!blueprint.has_value()) {
+      TraceLog(LOG_ERROR, "Cannot load next level %s, staying on %s", level_files[next_index()].c_str(),
+               level_files[current].c_str());
+      preload_next();
+      return std::nullopt;
+    }
+
+    current = next_index();
+    preload_next();
+    return blueprint;
+  }
+
+  /**
+   * Parses the next level again if `filename` is its map file, e.g. after it was saved.
+   */
+  void on_level_file_changed(std::string const& filename) {
+    if (filename == level_files[next_index()]) preload_next();
+  }
+
+  std::string const& current_file() const {
+    return level_files[current];
+  }
+
+  std::vector<std::string> const& get_level_files() const {
+    return level_files;
+  }
+
+ private:
+  std::vector<std::string> level_files;
+  size_t current{0};
+  std::future<std::optional<LevelBlueprint>> next_blueprint{};
+
+  size_t next_index() const {
+    return (current + 1) % level_files.size();
+  }
+
+  void preload_next() {
+    // Replacing a pending future waits for it first.
+    next_blueprint = std::async(std::launch::async, [filename = level_files[next_index()]]() {
+      return try_level_blueprint_from_file(filename.c_str());
+    });
+  }
+};
@@ -3,22 +3,19 @@
 #include <algorithm>
 #include <cmath>
 
+#include "animation.h"
 #include "asset_manager.h"
 #include "map.h"
+#include "particles.h"
+#include "player_physics.h"
 #include "raylib.h"
 #include "sprite_group.h"
 
 constexpr int PLAYER_TEXTURE_SIZE{32};
 
-constexpr float PLAYER_MAX_REL_SPEED = 500.f;
-constexpr float PLAYER_MOVEMENT_FRICTION = 0.9f;
-constexpr float PLAYER_ZERO_SPEED_THRESHOLD = 0.1f;
-constexpr float PLAYER_JUMP_SPEED = -750.f;
-constexpr float PLAYER_GRAVITY = 0.96f;
-constexpr float PLAYER_GRAVITY_INV = 1.f / PLAYER_GRAVITY;
-constexpr float PLAYER_FALL_BACK_THRESHOLD = 100.f;
-constexpr float PLAYER_MAX_FALL_SPEED = PLAYER_MAX_REL_SPEED;
-constexpr float PLAYER_MULTI_JUMP_MAX = 2;
+constexpr int PLAYER_MAX_SWEEPS{3};
+// Landing faster than this raises dust.
+constexpr float PLAYER_LAND_DUST_SPEED{PLAYER_MAX_FALL_SPEED / 2.f};
 
 constexpr int PLAYER_SPRITE_RUN{0};
 constexpr int PLAYER_SPRITE_IDLE{1};
@@ -30,6 +27,9 @@ constexpr int PLAYER_SPRITE_WALL_JUMP{6};
 
 constexpr Vector2 const AppearDisappearSpriteOffset{-32.f, -32.f};
 
+constexpr int CHARACTER_ANIMATION_APPEAR{0};
+constexpr int CHARACTER_ANIMATION_DISAPPEAR{1};
+
 enum class JumpState {
   Ground,
   Jump,
@@ -44,68 +44,46 @@ enum class LifecycleState {
   Injured,
 };
 
-struct Character {
+struct Character : AnimationListener {
  public:
-  Character(int const pixel_size) : pixel_size(pixel_size), appear_sprite(pixel_size), disappear_sprite(pixel_size) {
+  Character(int const pixel_size)
+      : pixel_size(pixel_size),
+        sprite_group(AnimationPrototype::Character1, static_cast<float>(pixel_size)),
+        appear_sprite(pixel_size),
+        disappear_sprite(pixel_size) {
+  }
+
+  ~Character() {
+    animation_clock.cancel(this);
   }
 
   void reset(Vector2 new_pos) {
     spawn_location = new_pos;
     pos = new_pos;
+    speed = vector_zero;
+    injury_timeout.cancel();
     sprite_group.reset();
     jump_state = JumpState::Ground;
     lifecycle_state = LifecycleState::Appear;
     multi_jump_count = PLAYER_MULTI_JUMP_MAX - 1;
+
+    animation_clock.cancel(this);
+    appear_sprite.play_once(this, CHARACTER_ANIMATION_APPEAR);
   }
 
   void init() {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                    asset_manager.textures[TextureNames::Character1__Run],
-                                    {32.f, 32.f},
-                                    12,
-                                    sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                    asset_manager.textures[TextureNames::Character1__Idle],
-                                    {32.f, 32.f},
-                                    11,
-                                    sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                    asset_manager.textures[TextureNames::Character1__Hit],
-                                    {32.f, 32.f},
-                                    7,
-                                    sprite_frame_length});
-    sprite_group.push_sprite(Sprite{
-        static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Character1__Jump], {32.f, 32.f}, 1, 0});
-    sprite_group.push_sprite(Sprite{
-        static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Character1__Fall], {32.f, 32.f}, 1, 0});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                    asset_manager.textures[TextureNames::Character1__Double_Jump],
-                                    {32.f, 32.f},
-                                    6,
-                                    sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                    asset_manager.textures[TextureNames::Character1__Wall_Jump],
-                                    {32.f, 32.f},
-                                    5,
-                                    sprite_frame_length});
-
     appear_sprite.init_texture(asset_manager.textures[TextureNames::Character__Appear], {96.f, 96.f}, 7,
-                               sprite_frame_length);
+                               DEFAULT_FRAME_TICKS);
 
     disappear_sprite.init_texture(asset_manager.textures[TextureNames::Character__Disappear], {96.f, 96.f}, 7,
-                                  sprite_frame_length);
+                                  DEFAULT_FRAME_TICKS);
   }
 
   void update(Map const& map) {
-    if (lifecycle_state == LifecycleState::Appear) {
-      if (appear_sprite.update() == 0) lifecycle_state = LifecycleState::Live;
-    } else if (lifecycle_state == LifecycleState::Disappear) {
-      if (disappear_sprite.update() == 0) reset(spawn_location);
+    if (lifecycle_state == LifecycleState::Appear || lifecycle_state == LifecycleState::Disappear) {
+      // Ends with `on_animation_end`.
     } else if (lifecycle_state == LifecycleState::Live || lifecycle_state == LifecycleState::Injured) {
       update_movement(map);
-      sprite_group.update();
     } else {
       BAIL;
     }
@@ -135,13 +113,19 @@ struct Character {
 
   void injure(bool const should_restart = false) {
     if (should_restart) {
+      if (lifecycle_state == LifecycleState::Disappear) return;
+
       lifecycle_state = LifecycleState::Disappear;
       injury_timeout.cancel();
+      animation_clock.cancel(this);
+      disappear_sprite.play_once(this, CHARACTER_ANIMATION_DISAPPEAR);
+      particles.emit(ParticleBurstCharacterHit, rect_center(hitbox()), pixel_size);
       return;
     }
 
     if (is_injured()) return;
 
+    particles.emit(ParticleBurstCharacterHit, rect_center(hitbox()), pixel_size);
     injury_timeout.cancel();
     lifecycle_state = LifecycleState::Injured;
     sprite_group.set_current_sprite(PLAYER_SPRITE_HIT);
@@ -163,6 +147,22 @@ struct Character {
     return lifecycle_state == LifecycleState::Injured;
   }
 
+  bool is_live() const {
+    return lifecycle_state == LifecycleState::Live;
+  }
+
+  void on_animation_end(int tag) override {
+    if (tag == CHARACTER_ANIMATION_APPEAR) {
+      appear_sprite.stop();
+      lifecycle_state = LifecycleState::Live;
+    } else if (tag == CHARACTER_ANIMATION_DISAPPEAR) {
+      disappear_sprite.stop();
+      reset(spawn_location);
+    } else {
+      BAIL;
+    }
+  }
+
   void bouncing_trap_interact() {
     multi_jump_count = 1;
     speed.y = PLAYER_JUMP_SPEED * 2.5f;
@@ -171,7 +171,7 @@ struct Character {
 
  private:
   const int pixel_size{DEFAULT_PIXEL_SIZE};
-  SpriteGroup sprite_group{};
+  SpriteGroup sprite_group;
   Sprite appear_sprite;
   Sprite disappear_sprite;
   Vector2 pos{};
@@ -181,14 +181,10 @@ struct Character {
   LifecycleState lifecycle_state{LifecycleState::Appear};
   Timeout injury_timeout{};
   Vector2 spawn_location{};
-
-  bool is_live() const {
-    return lifecycle_state == LifecycleState::Live;
-  }
+  bool is_grab_wall{false};
 
   void update_movement(Map const& map) {
-    HitMap hit_map = calculate_hitmap(map);
-    bool is_grab_wall{false};
+    pos = Vector2Add(pos, map.platform_carry(hitbox()));
 
     if (is_live() && IsKeyDown(KEY_LEFT)) {
       sprite_group.horizontal_flip();
@@ -209,24 +205,9 @@ struct Character {
       if (fabs(speed.x) < PLAYER_ZERO_SPEED_THRESHOLD) speed.x = 0.f;
     }
 
-    pos.x += speed.x * GetFrameTime();
-    Rectangle _hitbox{hitbox()};
-
-    // Adjust for wall hit.
-    float west_wall_dist = leftx(_hitbox) - hit_map.west;
-    if (west_wall_dist < 0) {
-      pos.x -= west_wall_dist;
-      speed.x = 0.f;
-      is_grab_wall = true;
-      multi_jump_count = PLAYER_MULTI_JUMP_MAX - 1;
-    }
-    float east_wall_dist = hit_map.east - rightx(_hitbox);
-    if (east_wall_dist < 0) {
-      pos.x += east_wall_dist;
-      speed.x = 0.f;
-      is_grab_wall = true;
-      multi_jump_count = PLAYER_MULTI_JUMP_MAX - 1;
-    }
+    // Horizontal first, a wall hit decides the wall grab and wall jump of this frame before gravity and the jump key.
+    is_grab_wall = false;
+    move_and_collide(map, Vector2{speed.x * GetFrameTime(), 0.f});
 
     if (is_live() && IsKeyPressed(KEY_SPACE) && multi_jump_count < PLAYER_MULTI_JUMP_MAX) {
       speed.y = PLAYER_JUMP_SPEED;
@@ -238,8 +219,6 @@ struct Character {
       }
     }
 
-    hit_map = calculate_hitmap(map);
-
     if (speed.y < 0.f) {
       // Raising.
       fps_independent_multiply(&speed.y, PLAYER_GRAVITY);
@@ -262,22 +241,7 @@ struct Character {
       speed.y = PLAYER_FALL_BACK_THRESHOLD;
     }
 
-    // TraceLog(LOG_INFO, "DY: %.2f", speed.y);
-    pos.y += speed.y * GetFrameTime();
-    _hitbox = hitbox();
-
-    // Adjust for wall hit.
-    float north_wall_dist = topy(_hitbox) - hit_map.north;
-    if (north_wall_dist < 0) {
-      pos.y -= north_wall_dist;
-      speed.y = 0.f;
-    }
-    float south_wall_dist = static_cast<float>(hit_map.south) - bottomy(_hitbox);
-    if (south_wall_dist < 0) {
-      pos.y += south_wall_dist;
-      speed.y = 0.f;
-      multi_jump_count = 0;
-    }
+    move_and_collide(map, Vector2{0.f, speed.y * GetFrameTime()});
 
     // Override sprite when jumping / wall grabbing.
     if (is_grab_wall) {
@@ -293,20 +257,43 @@ struct Character {
     }
   }
 
-  float speed_increments() const {
-    return (PLAYER_MAX_REL_SPEED / (30.f / FPSMultiplier));
+  /**
+   * Moves along `motion` and slides along every surface hit on the way. One map sweep per contact.
+   */
+  void move_and_collide(Map const& map, Vector2 motion) {
+    for (int i = 0; i < PLAYER_MAX_SWEEPS && (motion.x != 0.f || motion.y != 0.f); i++) {
+      SweepHit const hit = map.sweep(hitbox(), motion);
+
+      pos = Vector2Add(pos, Vector2Scale(motion, hit.time));
+      if (hit.time >= 1.f) return;
+
+      motion = Vector2Scale(motion, 1.f - hit.time);
+
+      // Snap the leading edge onto the surface.
+      Rectangle const hitbox_offset{upscale(CHARACTER_HITBOX, pixel_size)};
+      if (hit.normal.x != 0) {
+        pos.x = hit.surface - hitbox_offset.x - (hit.normal.x < 0 ? hitbox_offset.width : 0.f);
+        motion.x = 0.f;
+        speed.x = 0.f;
+        is_grab_wall = true;
+        multi_jump_count = PLAYER_MULTI_JUMP_MAX - 1;
+      } else {
+        pos.y = hit.surface - hitbox_offset.y - (hit.normal.y < 0 ? hitbox_offset.height : 0.f);
+        motion.y = 0.f;
+        if (hit.normal.y < 0) {
+          multi_jump_count = 0;
+          if (speed.y > PLAYER_LAND_DUST_SPEED) {
+            Rectangle const feet{hitbox()};
+            particles.emit(ParticleBurstLand, Vector2{feet.x + feet.width / 2.f, bottomy(feet)}, pixel_size);
+          }
+        }
+        speed.y = 0.f;
+      }
+    }
   }
 
-  HitMap calculate_hitmap(Map const& map) const {
-    HitMap hit_map{};
-    Rectangle const _hitbox{hitbox()};
-
-    hit_map.east = map.east_wall_of_range(_hitbox);
-    hit_map.north = map.north_wall_of_range(_hitbox);
-    hit_map.south = map.south_wall_of_range(_hitbox);
-    hit_map.west = map.west_wall_of_range(_hitbox);
-
-    return hit_map;
+  float speed_increments() const {
+    return (PLAYER_MAX_REL_SPEED / (30.f / FPSMultiplier));
   }
 
   void end_injury() {
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "common.h"
+
+/**
+ * Highest set bit below `index` in a bit string of `words`, or -1.
+ */
+int last_set_bit_before(uint64_t const* words, int index) {
+  int word = index >> 6;
+  int bit = index & 63;
+  uint64_t mask = bit == 0 ? 0 : words[word] & ((uint64_t{1} << bit) - 1);
+
+  while (true) {
+    if (mask != 0) return (word << 6) + 63 - std::countl_zero(mask);
+    if (--word < 0) return -1;
+    mask = words[word];
+  }
+}
+
+/**
+ * Lowest set bit above `index` in a bit string of `word_count` words, or -1.
+ */
+int first_set_bit_after(uint64_t const* words, int word_count, int index) {
+  int start = index + 1;
+  int word = start >> 6;
+  if (word >= word_count) return -1;
+  uint64_t mask = words[word] & (~uint64_t{0} << (start & 63));
+
+  while (true) {
+    if (mask != 0) return (word << 6) + std::countr_zero(mask);
+    if (++word >= word_count) return -1;
+    mask = words[word];
+  }
+}
+
+/**
+ * Wall collision directions of a tile grid, one bit per cell and direction. LEFT and RIGHT are stored row-major for the
+ * horizontal wall queries, TOP and BOTTOM column-major for the vertical ones, so each query scans contiguous words.
+ */
+struct CollisionBitboard {
+ public:
+  void resize(int new_width, int new_height) {
+    width = new_width;
+    height = new_height;
+    words_per_row = (width + 63) / 64;
+    words_per_column = (height + 63) / 64;
+
+    left_rows.assign(height * words_per_row, 0);
+    right_rows.assign(height * words_per_row, 0);
+    top_columns.assign(width * words_per_column, 0);
+    bottom_columns.assign(width * words_per_column, 0);
+  }
+
+  void clear() {
+    resize(0, 0);
+  }
+
+  void set(int x, int y, int directions) {
+    set_bit(&left_rows[y * words_per_row], x, directions & COLLISION_TYPE_LEFT);
+    set_bit(&right_rows[y * words_per_row], x, directions & COLLISION_TYPE_RIGHT);
+    set_bit(&top_columns[x * words_per_column], y, directions & COLLISION_TYPE_TOP);
+    set_bit(&bottom_columns[x * words_per_column], y, directions & COLLISION_TYPE_BOTTOM);
+  }
+
+  int get(int x, int y) const {
+    int directions{COLLISION_TYPE_NOTHING};
+    if (get_bit(&left_rows[y * words_per_row], x)) directions |= COLLISION_TYPE_LEFT;
+    if (get_bit(&right_rows[y * words_per_row], x)) directions |= COLLISION_TYPE_RIGHT;
+    if (get_bit(&top_columns[x * words_per_column], y)) directions |= COLLISION_TYPE_TOP;
+    if (get_bit(&bottom_columns[x * words_per_column], y)) directions |= COLLISION_TYPE_BOTTOM;
+    return directions;
+  }
+
+  int get_width() const {
+    return width;
+  }
+
+  int get_height() const {
+    return height;
+  }
+
+  /**
+   * Row of the nearest cell above (x, y) that blocks from below, or -1.
+   */
+  int bottom_wall_above(int x, int y) const {
+    return last_set_bit_before(&bottom_columns[x * words_per_column], y);
+  }
+
+  /**
+   * Row of the nearest cell below (x, y) that blocks from above, or `height`.
+   */
+  int top_wall_below(int x, int y) const {
+    int found = first_set_bit_after(&top_columns[x * words_per_column], words_per_column, y);
+    return found == -1 ? height : found;
+  }
+
+  /**
+   * Column of the nearest cell left of (x, y) that blocks from the left, or -1.
+   */
+  int left_wall_before(int x, int y) const {
+    return last_set_bit_before(&left_rows[y * words_per_row], x);
+  }
+
+  /**
+   * Column of the nearest cell right of (x, y) that blocks from the right, or `width`.
+   */
+  int right_wall_after(int x, int y) const {
+    int found = first_set_bit_after(&right_rows[y * words_per_row], words_per_row, x);
+    return found == -1 ? width : found;
+  }
+
+ private:
+  int width{0};
+  int height{0};
+  int words_per_row{0};
+  int words_per_column{0};
+  std::vector<uint64_t> left_rows{};
+  std::vector<uint64_t> right_rows{};
+  std::vector<uint64_t> top_columns{};
+  std::vector<uint64_t> bottom_columns{};
+
+  static void set_bit(uint64_t* words, int index, bool value) {
+    uint64_t bit = uint64_t{1} << (index & 63);
+    if (value) {
+      words[index >> 6] |= bit;
+    } else {
+      words[index >> 6] &= ~bit;
+    }
+  }
+
+  static bool get_bit(uint64_t const* words, int index) {
+    return (words[index >> 6] >> (index & 63)) & 1;
+  }
+};
@@ -3,18 +3,24 @@
 #include <cstdio>
 #include <cstdlib>
 #include <functional>
+#include <optional>
 
+#include "logger.h"
 #include "raylib.h"
 #include "raymath.h"
+#include "sprite_sheet.h"
 
+// Fatal errors are written synchronously, after everything the logger still holds.
 #define BAIL                                                             \
   {                                                                      \
+    logger.flush();                                                      \
     fprintf(stderr, "\x1b[94mBAIL\x1b[0m in %s:%d", __FILE__, __LINE__); \
     exit(EXIT_FAILURE);                                                  \
   }
 
 #define BAILF(...)                                                        \
   {                                                                       \
+    logger.flush();                                                       \
     log("\x1b[94mBAIL\x1b[0m in %s:%d", __FILE__, __LINE__, __VA_ARGS__); \
     exit(EXIT_FAILURE);                                                   \
   }
@@ -23,6 +29,8 @@ constexpr int const ReferenceFPS{144};
 // Set after window initialization.
 static int GameFPS{};
 static float FPSMultiplier{};
+// Seconds the current entity update advances: the frame time, or more for entities updated at a reduced rate.
+inline float UpdateDeltaTime{};
 
 constexpr int const DEFAULT_PIXEL_SIZE{2};
 
@@ -30,6 +38,8 @@ constexpr int const TILE_SIZE{16};
 
 constexpr Vector2 const vector_zero{0.f, 0.f};
 
+constexpr float const WALL_CHECK_THRESHOLD{3.f};
+
 constexpr int const COLLISION_TYPE_NOTHING{0b0000};
 constexpr int const COLLISION_TYPE_TOP{0b0001};
 constexpr int const COLLISION_TYPE_BOTTOM{0b0010};
@@ -52,8 +62,10 @@ constexpr Rectangle const Trap4Hitbox{16.f, 38.f, 16.f, 10.f};
 constexpr Rectangle const Trap5Hitbox{8.f, 20.f, 32.f, 8.f};
 constexpr Rectangle const Trap5Hitbox__UpperSurface{8.f, 18.f, 32.f, 8.f};
 constexpr Rectangle const Trap6Hitbox{16.f, 26.f, 16.f, 22.f};
+constexpr Rectangle const EndHitbox{16.f, 16.f, 32.f, 48.f};
 
 constexpr Vector2 const SIMPLE_WALK_NPC_SIZE{48.f, 48.f};
+constexpr Vector2 const END_CHECKPOINT_SIZE{64.f, 64.f};
 
 constexpr Rectangle const OutsideRectangle{-100.f, -100.f, 0.f, 0.f};
 
@@ -102,6 +114,10 @@ float bottomy(Rectangle const& rect) {
   return rect.y + rect.height - 1.f;
 }
 
+Vector2 rect_center(Rectangle const& rect) {
+  return Vector2{rect.x + rect.width / 2.f, rect.y + rect.height / 2.f};
+}
+
 struct IntVec2 {
   int x{0};
   int y{0};
@@ -136,11 +152,14 @@ IntVec2 vector2_to_intvec2(Vector2 const v) {
 constexpr IntVec2 const intvec2_0_0{0, 0};
 constexpr IntVec2 const intvec2_4_4{4, 4};
 
-IntVec2 intvec2_from_file(FILE* file) {
+/**
+ * Empty when the file ends early.
+ */
+std::optional<IntVec2> intvec2_from_file(FILE* file) {
   IntVec2 out{};
 
-  if (std::fread(&out.x, sizeof(int), 1, file) != 1) BAIL;
-  if (std::fread(&out.y, sizeof(int), 1, file) != 1) BAIL;
+  if (std::fread(&out.x, sizeof(int), 1, file) != 1) return std::nullopt;
+  if (std::fread(&out.y, sizeof(int), 1, file) != 1) return std::nullopt;
 
   return out;
 }
@@ -160,37 +179,6 @@ struct hash<IntVec2> {
 };
 }  // namespace std
 
-struct Stepper {
- public:
-  Stepper() {
-  }
-  Stepper(unsigned int threshold) : threshold(threshold) {
-  }
-
-  void set_threshold(unsigned int new_threshold) {
-    threshold = new_threshold;
-    reset();
-  }
-
-  void reset() {
-    counter = 0;
-  }
-
-  bool update() {
-    if (counter >= threshold) {
-      counter = 0;
-      return true;
-    } else {
-      counter++;
-      return false;
-    }
-  }
-
- private:
-  unsigned int counter{0};
-  unsigned int threshold{};
-};
-
 constexpr Rectangle upscale(Rectangle const rect, float const scale) {
   return Rectangle{rect.x * scale, rect.y * scale, rect.width * scale, rect.height * scale};
 }
@@ -276,89 +264,295 @@ enum class TileSource {
   Trap4,
   Trap5,
   Trap6,
+  End,
+};
+
+constexpr int const TILE_SOURCE_COUNT{static_cast<int>(TileSource::End) + 1};
+
+constexpr IntVec2 const TILESIZE_DEFAULT{TILE_SIZE, TILE_SIZE};
+constexpr IntVec2 const TILESIZE_BOX{32, 32};
+constexpr IntVec2 const TILESIZE_ENEMY1{48, 48};
+constexpr IntVec2 const TILESIZE_END{64, 64};
+
+constexpr int const TEXTURE_NONE{-1};
+
+/**
+ * Who owns the tiles of a kind once a level is loaded.
+ */
+enum class TileClass {
+  Wall,
+  Box,
+  InteractiveObject,
+  Npc,
+  Trap,
+};
+
+/**
+ * Editor pane offering a tile kind.
+ */
+enum class TilePalette {
+  Walls,
+  Boxes,
+  Enemies,
+  Traps,
+};
+
+/**
+ * Static facts of one `TileSource`. Textures are `TextureNames` values, `TEXTURE_NONE` marks an unused slot.
+ */
+struct TileKind {
+  TileSource source;
+  char const* name;
+  TileClass tile_class;
+  TilePalette palette;
+  Rectangle hitbox;
+  IntVec2 size;
+  int snap;
+  // `COLLISION_TYPE_*` mask of the whole kind, unless a per tile map is given (indexed by tile coord on the sheet).
+  int collision_directions;
+  int const* collision_map;
+  // Drawn by `TileSelection::draw`, the sheet the tile coord points into.
+  int texture;
+  int palette_texture;
+  // Loaded while a level using the kind is played.
+  int game_textures[2];
+  AnimationPrototype animations[2];
+  int animation_count;
+};
+
+// Indexed by `TileSource`, the index is also the map file code.
+constexpr TileKind const TILE_KINDS[TILE_SOURCE_COUNT]{
+    {.source = TileSource::Gui,
+     .name = "Gui",
+     .tile_class = TileClass::Wall,
+     .palette = TilePalette::Walls,
+     .hitbox = DEFAULT_TILE_HITBOX,
+     .size = TILESIZE_DEFAULT,
+     .snap = TILE_SIZE,
+     .collision_directions = COLLISION_TYPE_ALL,
+     .collision_map = nullptr,
+     .texture = TextureNames::GuiTiles,
+     .palette_texture = TextureNames::GuiTiles,
+     .game_textures = {TextureNames::GuiTiles, TEXTURE_NONE}},
+    {.source = TileSource::Tileset,
+     .name = "Tileset",
+     .tile_class = TileClass::Wall,
+     .palette = TilePalette::Walls,
+     .hitbox = DEFAULT_TILE_HITBOX,
+     .size = TILESIZE_DEFAULT,
+     .snap = TILE_SIZE,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = tileset_tile_collision_map,
+     .texture = TextureNames::TilesetTiles,
+     .palette_texture = TextureNames::TilesetTiles,
+     .game_textures = {TextureNames::TilesetTiles, TEXTURE_NONE}},
+    {.source = TileSource::Box1,
+     .name = "Box1",
+     .tile_class = TileClass::Box,
+     .palette = TilePalette::Boxes,
+     .hitbox = BOX_HITBOX,
+     .size = TILESIZE_BOX,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_ALL,
+     .collision_map = nullptr,
+     .texture = TextureNames::Box1__Idle,
+     .palette_texture = TextureNames::Box1__Idle,
+     .game_textures = {TextureNames::Box1__Idle, TEXTURE_NONE}},
+    {.source = TileSource::Box2,
+     .name = "Box2",
+     .tile_class = TileClass::Box,
+     .palette = TilePalette::Boxes,
+     .hitbox = BOX_HITBOX,
+     .size = TILESIZE_BOX,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_ALL,
+     .collision_map = nullptr,
+     .texture = TextureNames::Box2__Idle,
+     .palette_texture = TextureNames::Box2__Idle,
+     .game_textures = {TextureNames::Box2__Idle, TEXTURE_NONE}},
+    {.source = TileSource::Box3,
+     .name = "Box3",
+     .tile_class = TileClass::Box,
+     .palette = TilePalette::Boxes,
+     .hitbox = BOX_HITBOX,
+     .size = TILESIZE_BOX,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_ALL,
+     .collision_map = nullptr,
+     .texture = TextureNames::Box3__Idle,
+     .palette_texture = TextureNames::Box3__Idle,
+     .game_textures = {TextureNames::Box3__Idle, TEXTURE_NONE}},
+    {.source = TileSource::Enemy1,
+     .name = "Enemy1",
+     .tile_class = TileClass::Npc,
+     .palette = TilePalette::Enemies,
+     .hitbox = ENEMY1_HITBOX,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Enemy1__Example,
+     .palette_texture = TextureNames::Enemy1__Example,
+     .game_textures = {TEXTURE_NONE, TEXTURE_NONE},
+     .animations = {AnimationPrototype::Enemy1},
+     .animation_count = 1},
+    {.source = TileSource::Enemy2,
+     .name = "Enemy2",
+     .tile_class = TileClass::Npc,
+     .palette = TilePalette::Enemies,
+     .hitbox = ENEMY2_HITBOX,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Enemy2__Jump,
+     .palette_texture = TextureNames::Enemy2__Fall,
+     .game_textures = {TEXTURE_NONE, TEXTURE_NONE},
+     .animations = {AnimationPrototype::Enemy2},
+     .animation_count = 1},
+    {.source = TileSource::Enemy3,
+     .name = "Enemy3",
+     .tile_class = TileClass::Npc,
+     .palette = TilePalette::Enemies,
+     .hitbox = ENEMY3_HITBOX,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Enemy3__Example,
+     .palette_texture = TextureNames::Enemy3__Example,
+     .game_textures = {TEXTURE_NONE, TEXTURE_NONE},
+     .animations = {AnimationPrototype::Enemy3},
+     .animation_count = 1},
+    {.source = TileSource::Enemy4,
+     .name = "Enemy4",
+     .tile_class = TileClass::Npc,
+     .palette = TilePalette::Enemies,
+     .hitbox = ENEMY4_HITBOX,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Enemy4__Example,
+     .palette_texture = TextureNames::Enemy4__Example,
+     .game_textures = {TEXTURE_NONE, TEXTURE_NONE},
+     .animations = {AnimationPrototype::Enemy4, AnimationPrototype::BulletShort},
+     .animation_count = 2},
+    {.source = TileSource::Enemy5,
+     .name = "Enemy5",
+     .tile_class = TileClass::Npc,
+     .palette = TilePalette::Enemies,
+     .hitbox = ENEMY5_HITBOX,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Enemy5__Example,
+     .palette_texture = TextureNames::Enemy5__Example,
+     .game_textures = {TEXTURE_NONE, TEXTURE_NONE},
+     .animations = {AnimationPrototype::Enemy5},
+     .animation_count = 1},
+    {.source = TileSource::Trap1,
+     .name = "Trap1",
+     .tile_class = TileClass::Trap,
+     .palette = TilePalette::Traps,
+     .hitbox = Trap1Hitbox,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Trap1__Example,
+     .palette_texture = TextureNames::Trap1__Example,
+     .game_textures = {TextureNames::Trap1, TEXTURE_NONE}},
+    {.source = TileSource::Trap2,
+     .name = "Trap2",
+     .tile_class = TileClass::Trap,
+     .palette = TilePalette::Traps,
+     .hitbox = Trap2Hitbox,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Trap2__Example,
+     .palette_texture = TextureNames::Trap2__Example,
+     .game_textures = {TextureNames::Trap2, TEXTURE_NONE}},
+    {.source = TileSource::Trap4,
+     .name = "Trap4",
+     .tile_class = TileClass::Trap,
+     .palette = TilePalette::Traps,
+     .hitbox = Trap4Hitbox,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Trap4__Example,
+     .palette_texture = TextureNames::Trap4__Example,
+     .game_textures = {TextureNames::Trap4, TEXTURE_NONE}},
+    {.source = TileSource::Trap5,
+     .name = "Trap5",
+     .tile_class = TileClass::InteractiveObject,
+     .palette = TilePalette::Traps,
+     .hitbox = Trap5Hitbox,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Trap5__Example,
+     .palette_texture = TextureNames::Trap5__Example,
+     .game_textures = {TextureNames::Trap5, TEXTURE_NONE}},
+    {.source = TileSource::Trap6,
+     .name = "Trap6",
+     .tile_class = TileClass::Trap,
+     .palette = TilePalette::Traps,
+     .hitbox = Trap6Hitbox,
+     .size = TILESIZE_ENEMY1,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::Trap6__Example,
+     .palette_texture = TextureNames::Trap6__Example,
+     .game_textures = {TextureNames::Trap6, TEXTURE_NONE}},
+    {.source = TileSource::End,
+     .name = "End",
+     .tile_class = TileClass::Trap,
+     .palette = TilePalette::Traps,
+     .hitbox = EndHitbox,
+     .size = TILESIZE_END,
+     .snap = 1,
+     .collision_directions = COLLISION_TYPE_NOTHING,
+     .collision_map = nullptr,
+     .texture = TextureNames::End__Idle,
+     .palette_texture = TextureNames::End__Idle,
+     .game_textures = {TextureNames::End__Idle, TextureNames::End__Pressed}},
 };
 
-Rectangle const tile_source_hitbox(TileSource tile_source) {
-  switch (tile_source) {
-    case TileSource::Gui:
-    case TileSource::Tileset:
-      return DEFAULT_TILE_HITBOX;
-    case TileSource::Box1:
-    case TileSource::Box2:
-    case TileSource::Box3:
-      return BOX_HITBOX;
-    case TileSource::Enemy1:
-      return ENEMY1_HITBOX;
-    case TileSource::Enemy2:
-      return ENEMY2_HITBOX;
-    case TileSource::Enemy3:
-      return ENEMY3_HITBOX;
-    case TileSource::Enemy4:
-      return ENEMY4_HITBOX;
-    case TileSource::Enemy5:
-      return ENEMY5_HITBOX;
-    case TileSource::Trap1:
-      return Trap1Hitbox;
-    case TileSource::Trap2:
-      return Trap2Hitbox;
-    case TileSource::Trap4:
-      return Trap4Hitbox;
-    case TileSource::Trap5:
-      return Trap5Hitbox;
-    case TileSource::Trap6:
-      return Trap6Hitbox;
-    default:
-      BAIL;
+constexpr bool is_tile_kinds_in_source_order() {
+  for (int i = 0; i < TILE_SOURCE_COUNT; i++) {
+    if (static_cast<int>(TILE_KINDS[i].source) != i) return false;
   }
+  return true;
+}
+
+static_assert(is_tile_kinds_in_source_order(), "TILE_KINDS rows must follow TileSource");
+
+constexpr TileKind const& tile_kind(TileSource const tile_source) {
+  return TILE_KINDS[static_cast<int>(tile_source)];
+}
+
+constexpr Rectangle tile_source_hitbox(TileSource const tile_source) {
+  return tile_kind(tile_source).hitbox;
 }
 
 Rectangle const tile_source_hitbox(TileSource tile_source, IntVec2 const pos) {
   return move(tile_source_hitbox(tile_source), pos);
 }
 
-constexpr IntVec2 const TILESIZE_DEFAULT{TILE_SIZE, TILE_SIZE};
-constexpr IntVec2 const TILESIZE_BOX{32, 32};
-constexpr IntVec2 const TILESIZE_ENEMY1{48, 48};
-
 struct TileSelection {
   TileSource source{};
   IntVec2 tile_coord{};
 
   void draw(Vector2 const pos, int const pixel_size) const {
-    std::shared_ptr<Texture2D> texture;
-    if (source == TileSource::Gui) {
-      texture = asset_manager.textures[TextureNames::GuiTiles];
-    } else if (source == TileSource::Tileset) {
-      texture = asset_manager.textures[TextureNames::TilesetTiles];
-    } else if (source == TileSource::Box1) {
-      texture = asset_manager.textures[TextureNames::Box1__Idle];
-    } else if (source == TileSource::Box2) {
-      texture = asset_manager.textures[TextureNames::Box2__Idle];
-    } else if (source == TileSource::Box3) {
-      texture = asset_manager.textures[TextureNames::Box3__Idle];
-    } else if (source == TileSource::Enemy1) {
-      texture = asset_manager.textures[TextureNames::Enemy1__Example];
-    } else if (source == TileSource::Enemy2) {
-      texture = asset_manager.textures[TextureNames::Enemy2__Jump];
-    } else if (source == TileSource::Enemy3) {
-      texture = asset_manager.textures[TextureNames::Enemy3__Example];
-    } else if (source == TileSource::Enemy4) {
-      texture = asset_manager.textures[TextureNames::Enemy4__Example];
-    } else if (source == TileSource::Enemy5) {
-      texture = asset_manager.textures[TextureNames::Enemy5__Example];
-    } else if (source == TileSource::Trap1) {
-      texture = asset_manager.textures[TextureNames::Trap1__Example];
-    } else if (source == TileSource::Trap2) {
-      texture = asset_manager.textures[TextureNames::Trap2__Example];
-    } else if (source == TileSource::Trap4) {
-      texture = asset_manager.textures[TextureNames::Trap4__Example];
-    } else if (source == TileSource::Trap5) {
-      texture = asset_manager.textures[TextureNames::Trap5__Example];
-    } else if (source == TileSource::Trap6) {
-      texture = asset_manager.textures[TextureNames::Trap6__Example];
-    } else {
-      BAIL;
-    }
+    std::shared_ptr<Texture2D> const& texture = asset_manager.textures[tile_kind(source).texture];
 
     IntVec2 _tile_size{tile_size()};
     DrawTexturePro(
@@ -374,63 +568,29 @@ struct TileSelection {
     tile_coord.write(file);
   }
 
+  bool operator==(TileSelection const& other) const {
+    return source == other.source && tile_coord == other.tile_coord;
+  }
+
+  /**
+   * Mask of the `COLLISION_TYPE_*` directions the tile blocks from.
+   */
+  int collision_directions() const {
+    TileKind const& kind = tile_kind(source);
+    if (kind.collision_map) return kind.collision_map[tile_coord.y * 16 + tile_coord.x] & COLLISION_TYPE_ALL;
+    return kind.collision_directions;
+  }
+
   bool collide_from(int direction) const {
-    if (source == TileSource::Gui) {
-      return true;
-    } else if (source == TileSource::Tileset) {
-      return (tileset_tile_collision_map[tile_coord.y * 16 + tile_coord.x] & direction) > 0;
-    } else {
-      BAIL;
-    }
+    return (collision_directions() & direction) > 0;
   }
 
   IntVec2 const tile_size() const {
-    switch (source) {
-      case TileSource::Gui:
-      case TileSource::Tileset:
-        return TILESIZE_DEFAULT;
-      case TileSource::Box1:
-      case TileSource::Box2:
-      case TileSource::Box3:
-        return TILESIZE_BOX;
-      case TileSource::Enemy1:
-      case TileSource::Enemy2:
-      case TileSource::Enemy3:
-      case TileSource::Enemy4:
-      case TileSource::Enemy5:
-      case TileSource::Trap1:
-      case TileSource::Trap2:
-      case TileSource::Trap4:
-      case TileSource::Trap5:
-      case TileSource::Trap6:
-        return TILESIZE_ENEMY1;
-      default:
-        BAIL;
-    }
+    return tile_kind(source).size;
   }
 
   int const snap() const {
-    switch (source) {
-      case TileSource::Gui:
-      case TileSource::Tileset:
-        return 16;
-      case TileSource::Box1:
-      case TileSource::Box2:
-      case TileSource::Box3:
-      case TileSource::Enemy1:
-      case TileSource::Enemy2:
-      case TileSource::Enemy3:
-      case TileSource::Enemy4:
-      case TileSource::Enemy5:
-      case TileSource::Trap1:
-      case TileSource::Trap2:
-      case TileSource::Trap4:
-      case TileSource::Trap5:
-      case TileSource::Trap6:
-        return 1;
-      default:
-        BAIL;
-    }
+    return tile_kind(source).snap;
   }
 
   Rectangle const hitbox(IntVec2 const pos) const {
@@ -442,63 +602,21 @@ struct TileSelection {
   }
 };
 
-TileSelection tile_selection_from_file(FILE* file) {
+/**
+ * Empty when the file ends early or names an unknown tile source.
+ */
+std::optional<TileSelection> tile_selection_from_file(FILE* file) {
   int tile_source_raw{};
-  if (fread(&tile_source_raw, sizeof(int), 1, file) != 1) BAIL;
-  IntVec2 pos = intvec2_from_file(file);
+  if (fread(&tile_source_raw, sizeof(int), 1, file) != 1) return std::nullopt;
+  std::optional<IntVec2> pos{intvec2_from_file(file)};
+  if (!pos.has_value()) return std::nullopt;
 
-  TileSource source{};
-  switch (tile_source_raw) {
-    case 0:
-      source = TileSource::Gui;
-      break;
-    case 1:
-      source = TileSource::Tileset;
-      break;
-    case 2:
-      source = TileSource::Box1;
-      break;
-    case 3:
-      source = TileSource::Box2;
-      break;
-    case 4:
-      source = TileSource::Box3;
-      break;
-    case 5:
-      source = TileSource::Enemy1;
-      break;
-    case 6:
-      source = TileSource::Enemy2;
-      break;
-    case 7:
-      source = TileSource::Enemy3;
-      break;
-    case 8:
-      source = TileSource::Enemy4;
-      break;
-    case 9:
-      source = TileSource::Enemy5;
-      break;
-    case 10:
-      source = TileSource::Trap1;
-      break;
-    case 11:
-      source = TileSource::Trap2;
-      break;
-    case 12:
-      source = TileSource::Trap4;
-      break;
-    case 13:
-      source = TileSource::Trap5;
-      break;
-    case 14:
-      source = TileSource::Trap6;
-      break;
-    default:
-      BAILF("Invalid: %d", tile_source_raw);
+  if (tile_source_raw < 0 || tile_source_raw >= TILE_SOURCE_COUNT) {
+    TraceLog(LOG_WARNING, "Invalid tile source: %d", tile_source_raw);
+    return std::nullopt;
   }
 
-  return TileSelection{source, pos};
+  return TileSelection{static_cast<TileSource>(tile_source_raw), *pos};
 }
 
 inline int mod_reduced(const int v, const int mod) {
@@ -530,11 +648,11 @@ bool is_vertical_overlap(Rectangle const& rect_lhs, Rectangle const& rect_rhs) {
 }
 
 void debug(Vector2 v, const char* msg) {
-  TraceLog(LOG_DEBUG, "%s :: Vector2 { %.2f, %.2f }", msg, v.x, v.y);
+  LOGF(LOG_DEBUG, "%s :: Vector2 { %.2f, %.2f }", msg, v.x, v.y);
 }
 
 void debug(Rectangle r, const char* msg) {
-  TraceLog(LOG_DEBUG, "%s :: Rectangle { %.2f, %.2f, %.2f, %.2f }", msg, r.x, r.y, r.width, r.height);
+  LOGF(LOG_DEBUG, "%s :: Rectangle { %.2f, %.2f, %.2f, %.2f }", msg, r.x, r.y, r.width, r.height);
 }
 
 float randf() {
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include "../asset_manager.h"
+#include "../background.h"
+#include "../common.h"
+#include "raylib.h"
+#include "tile_index.h"
+
+// Chunk edge in unscaled map pixels (32 tiles). Multiple of `BACKGROUND_SIZE` so background tiles never straddle chunks.
+constexpr int const EDITOR_CHUNK_SIZE{TILE_SIZE * 32};
+// Re-bakes per frame. Chunks over budget keep their previous texture until a later frame.
+constexpr int const EDITOR_CHUNK_BAKES_PER_FRAME{8};
+// Baked chunks kept around; invisible ones are released above this.
+constexpr size_t const EDITOR_CHUNK_CACHE_CAPACITY{128};
+
+struct EditorChunk {
+  RenderTexture2D render_texture{};
+  bool is_baked{false};
+  bool is_dirty{true};
+};
+
+/**
+ * Editor canvas split into chunks, each baked (background and tiles) into a render texture at unscaled resolution and
+ * re-baked only when an edit touches it. Only chunks inside the view are baked and drawn.
+ */
+struct EditorChunkCache {
+ public:
+  void unload() {
+    for (auto& [_, chunk] : chunks) {
+      if (chunk.is_baked) UnloadRenderTexture(chunk.render_texture);
+    }
+    chunks.clear();
+  }
+
+  void mark_dirty(Rectangle const& region) {
+    for_each_chunk_coord(region, [&](IntVec2 const coord) {
+      auto it = chunks.find(coord);
+      if (it != chunks.end()) it->second.is_dirty = true;
+    });
+  }
+
+  void mark_all_dirty() {
+    for (auto& [_, chunk] : chunks) chunk.is_dirty = true;
+  }
+
+  /**
+   * Bakes the dirty chunks inside `view` (within budget). Must be called outside `BeginMode2D`: render texture mode
+   * drops the camera transform.
+   */
+  void bake_visible(Rectangle const& view, TileIndex const& tiles, int background_index, IntVec2 map_size) {
+    Rectangle visible{view};
+    clip_to_map(&visible, map_size);
+    if (visible.width <= 0.f || visible.height <= 0.f) return;
+
+    int bakes{0};
+    for_each_chunk_coord(visible, [&](IntVec2 const coord) {
+      EditorChunk& chunk = chunks[coord];
+      // Never baked chunks are always baked, otherwise they would show as holes.
+      if (chunk.is_dirty && (bakes < EDITOR_CHUNK_BAKES_PER_FRAME || !chunk.is_baked)) {
+        bake(coord, &chunk, tiles, background_index, map_size);
+        bakes++;
+      }
+    });
+
+    evict(visible);
+  }
+
+  /**
+   * Draws the baked chunks inside `view`. World units are unscaled map pixels (inside `BeginMode2D`).
+   */
+  void draw(Rectangle const& view, IntVec2 map_size) const {
+    Rectangle visible{view};
+    clip_to_map(&visible, map_size);
+    if (visible.width <= 0.f || visible.height <= 0.f) return;
+
+    for_each_chunk_coord(visible, [&](IntVec2 const coord) {
+      auto it = chunks.find(coord);
+      if (it == chunks.end() || !it->second.is_baked) return;
+
+      DrawTextureRec(it->second.render_texture.texture,
+                     {0.f, 0.f, static_cast<float>(EDITOR_CHUNK_SIZE), -static_cast<float>(EDITOR_CHUNK_SIZE)},
+                     chunk_origin(coord), WHITE);
+    });
+  }
+
+ private:
+  std::unordered_map<IntVec2, EditorChunk> chunks{};
+
+  static int chunk_coord(float v) {
+    return static_cast<int>(std::floor(v / EDITOR_CHUNK_SIZE));
+  }
+
+  static Vector2 chunk_origin(IntVec2 const coord) {
+    return Vector2{static_cast<float>(coord.x * EDITOR_CHUNK_SIZE), static_cast<float>(coord.y * EDITOR_CHUNK_SIZE)};
+  }
+
+  static Rectangle chunk_bounds(IntVec2 const coord) {
+    Vector2 origin{chunk_origin(coord)};
+    return Rectangle{origin.x, origin.y, static_cast<float>(EDITOR_CHUNK_SIZE), static_cast<float>(EDITOR_CHUNK_SIZE)};
+  }
+
+  static void clip_to_map(Rectangle* region, IntVec2 map_size) {
+    float min_x = std::max(region->x, 0.f);
+    float min_y = std::max(region->y, 0.f);
+    float max_x = std::min(region->x + region->width, static_cast<float>(map_size.x));
+    float max_y = std::min(region->y + region->height, static_cast<float>(map_size.y));
+    *region = Rectangle{min_x, min_y, max_x - min_x, max_y - min_y};
+  }
+
+  template <typename F>
+  static void for_each_chunk_coord(Rectangle const& region, F&& f) {
+    int min_x = chunk_coord(region.x);
+    int min_y = chunk_coord(region.y);
+    // Right and bottom edges are exclusive.
+    int max_x = chunk_coord(std::nextafter(region.x + region.width, -INFINITY));
+    int max_y = chunk_coord(std::nextafter(region.y + region.height, -INFINITY));
+
+    for (int y = min_y; y <= max_y; y++) {
+      for (int x = min_x; x <= max_x; x++) f(IntVec2{x, y});
+    }
+  }
+
+  void bake(IntVec2 const coord, EditorChunk* chunk, TileIndex const& tiles, int background_index, IntVec2 map_size) {
+    if (!chunk->is_baked) {
+      chunk->render_texture = LoadRenderTexture(EDITOR_CHUNK_SIZE, EDITOR_CHUNK_SIZE);
+      chunk->is_baked = true;
+    }
+
+    Vector2 origin{chunk_origin(coord)};
+    Rectangle region{chunk_bounds(coord)};
+
+    BeginTextureMode(chunk->render_texture);
+    ClearBackground(BLANK);
+
+    if (background_index >= 0 && background_index < BACKGROUND_COUNT) {
+      Texture2D const& texture = *asset_manager.textures[TextureNames::Background__0 + background_index];
+
+      for (int y = 0; y < EDITOR_CHUNK_SIZE; y += BACKGROUND_SIZE) {
+        for (int x = 0; x < EDITOR_CHUNK_SIZE; x += BACKGROUND_SIZE) {
+          // Cropped at the map edge.
+          float width = std::min(static_cast<float>(BACKGROUND_SIZE), map_size.x - (origin.x + x));
+          float height = std::min(static_cast<float>(BACKGROUND_SIZE), map_size.y - (origin.y + y));
+          if (width <= 0.f || height <= 0.f) continue;
+
+          DrawTextureRec(texture, {0.f, 0.f, width, height}, {static_cast<float>(x), static_cast<float>(y)}, WHITE);
+        }
+      }
+    }
+
+    tiles.for_each_in(region, [&](IntVec2 const pos, TileSelection const& selection) {
+      selection.draw(Vector2Subtract(pos.to_vector2(), origin), 1);
+    });
+
+    EndTextureMode();
+
+    chunk->is_dirty = false;
+  }
+
+  void evict(Rectangle const& visible) {
+    if (chunks.size() <= EDITOR_CHUNK_CACHE_CAPACITY) return;
+
+    std::erase_if(chunks, [&](auto& entry) {
+      auto& [coord, chunk] = entry;
+      if (CheckCollisionRecs(chunk_bounds(coord), visible)) return false;
+
+      if (chunk.is_baked) UnloadRenderTexture(chunk.render_texture);
+      return true;
+    });
+  }
+};
@@ -4,15 +4,27 @@
 #include <list>
 
 #include "../asset_manager.h"
-#include "../background.h"
 #include "../common.h"
+#include "../level.h"
+#include "../texture_reloader.h"
+#include "chunk_cache.h"
 #include "common.h"
 #include "imgui.h"
+#include "level_saver.h"
 #include "raylib.h"
 #include "rlImGui.h"
+#include "tile_index.h"
 
 constexpr const int fixed_pixel_size{2};
 
+constexpr int const EDITOR_MAX_TILE_COUNT{1024};
+constexpr float const EDITOR_MIN_ZOOM{0.25f};
+constexpr float const EDITOR_MAX_ZOOM{4.f};
+constexpr float const EDITOR_ZOOM_STEP{1.1f};
+// Screen pixels per second.
+constexpr float const EDITOR_PAN_SPEED{800.f};
+constexpr double const EDITOR_AUTOSAVE_INTERVAL{60.0};
+
 static std::vector<const char*> group_list_names{};
 
 enum class SpecialOperation {
@@ -20,165 +32,114 @@ enum class SpecialOperation {
   GroupElemSelect,
 };
 
-enum class ObjectBehaviourType {
-  VerticalMovement,
-  HorizontalMovement,
-};
-
-struct ObjectBehaviour {
-  ObjectBehaviourType type;
-  union {
-    IntVec2 movement_range;
-  };
-};
-
-ObjectBehaviour make_object_behaviour__vertical_movement() {
-  return ObjectBehaviour{ObjectBehaviourType::VerticalMovement, IntVec2{0, 0}};
-}
-
-ObjectBehaviour make_object_behaviour__horizontal_movement() {
-  return ObjectBehaviour{ObjectBehaviourType::HorizontalMovement, IntVec2{0, 0}};
-}
-
-struct InteractiveGroup {
- public:
-  void add_elem(IntVec2 const coord) {
-    elems.push_back(coord);
-  }
-
-  std::vector<IntVec2> const& get_elems() const {
-    return elems;
-  }
-
-  std::vector<ObjectBehaviour>& get_behaviours() {
-    return behaviours;
-  }
-
-  void add_behaviour(ObjectBehaviourType type) {
-    switch (type) {
-      case ObjectBehaviourType::HorizontalMovement:
-        behaviours.push_back(make_object_behaviour__horizontal_movement());
-        break;
-      case ObjectBehaviourType::VerticalMovement:
-        behaviours.push_back(make_object_behaviour__vertical_movement());
-        break;
-      default:
-        BAIL;
-        break;
-    }
-  }
-
- private:
-  std::vector<IntVec2> elems{};
-  std::vector<ObjectBehaviour> behaviours{};
-};
-
 struct Editor {
  public:
   Editor() {
-    background.preload(0, tile_width, tile_height, pixel_size);
+    camera.zoom = static_cast<float>(pixel_size);
+    texture_reloader.watch_all();
   }
 
   void load_from_file() {
     reset();
 
-    FILE* file = std::fopen("assets/maps/map.mp", "r");
-    if (!file) BAILF("Cannot open map file");
-
-    int background_index{};
-    int tiles_count{};
-    if (std::fread(&tile_width, sizeof(int), 1, file) != 1) BAIL;
-    if (std::fread(&tile_height, sizeof(int), 1, file) != 1) BAIL;
-    if (std::fread(&background_index, sizeof(int), 1, file) != 1) BAIL;
-    if (std::fread(&tiles_count, sizeof(int), 1, file) != 1) BAIL;
-
-    character_position = intvec2_from_file(file);
+    LevelBlueprint blueprint{level_blueprint_from_file(DEFAULT_MAP_FILE)};
 
-    background.preload(background_index, tile_width, tile_height, pixel_size);
+    tile_width = blueprint.tile_width;
+    tile_height = blueprint.tile_height;
+    character_position = blueprint.character_position;
 
-    for (int i = 0; i < tiles_count; i++) {
-      IntVec2 tile_pos = intvec2_from_file(file);
-      TileSelection tile_selection{tile_selection_from_file(file)};
+    background_index = blueprint.background_index;
 
-      tiles[tile_pos] = tile_selection;
-    }
+    for (auto const& [tile_pos, tile_selection] : blueprint.tiles) tiles.set(tile_pos, tile_selection);
+    chunk_cache.mark_all_dirty();
 
-    std::fclose(file);
+    interactive_groups = std::move(blueprint.interactive_groups);
+    sync_group_list_names();
   }
 
   void update() {
-    Vector2 mouse_pos = GetMousePosition();
+    if (texture_reloader.update()) chunk_cache.mark_all_dirty();
+
+    update_camera();
 
-    if (CheckCollisionPointRec(mouse_pos, game_area())) {
+    Vector2 mouse_pos = map_pos(GetMousePosition());
+    bool const is_mouse_on_map = !ImGui::GetIO().WantCaptureMouse && CheckCollisionPointRec(mouse_pos, map_area());
+
+    if (is_mouse_on_map) {
       if (special_operation == SpecialOperation::Nothing) {
         if (IsMouseButtonDown(0)) {
           // Draw tile.
-          IntVec2 int_coord{mod_reduced(mouse_pos.x, tile_selection.snap() * pixel_size) / pixel_size,
-                            mod_reduced(mouse_pos.y, tile_selection.snap() * pixel_size) / pixel_size};
-          tiles[int_coord] = tile_selection;
+          paint_tile(IntVec2{mod_reduced(static_cast<int>(mouse_pos.x), tile_selection.snap()),
+                             mod_reduced(static_cast<int>(mouse_pos.y), tile_selection.snap())});
         }
       } else if (special_operation == SpecialOperation::GroupElemSelect) {
         if (IsMouseButtonReleased(0)) {
-          for (auto const& [tile_pos, tile_selection] : tiles) {
-            if (CheckCollisionPointRec(mouse_pos, tile_selection.hitbox(tile_pos, pixel_size))) {
-              interactive_groups[active_interactive_group].add_elem(tile_pos);
-              break;
-            }
+          IntVec2 tile_pos{};
+          if (tiles.find_at(mouse_pos, &tile_pos)) {
+            interactive_groups[active_interactive_group].add_elem(tile_pos);
+            has_changes_since_autosave = true;
           }
           special_operation = SpecialOperation::Nothing;
         }
       }
     }
 
-    if (IsMouseButtonDown(1)) {
+    if (IsMouseButtonDown(1) && is_mouse_on_map) {
       // Erase tile.
-      if (CheckCollisionPointRec(mouse_pos, game_area())) {
-        std::erase_if(tiles, [&](const auto& p) {
-          IntVec2 const& pos = p.first;
-          TileSelection const& selection = p.second;
-
-          const Rectangle hitbox = selection.hitbox(pos, pixel_size);
-          return CheckCollisionPointRec(mouse_pos, hitbox);
-        });
-      }
+      tiles.erase_at(mouse_pos, [&](IntVec2 const pos, TileSelection const& selection) {
+        chunk_cache.mark_dirty(tile_bounds(pos, selection));
+        has_changes_since_autosave = true;
+      });
     }
 
-    if (IsMouseButtonDown(2)) {
-      character_position.x = mouse_pos.x / pixel_size;
-      character_position.y = mouse_pos.y / pixel_size;
+    if (IsMouseButtonDown(2) && is_mouse_on_map) {
+      character_position.x = static_cast<int>(mouse_pos.x);
+      character_position.y = static_cast<int>(mouse_pos.y);
+      has_changes_since_autosave = true;
+    }
+
+    if (autosave_timer.update() && is_autosave_enabled && has_changes_since_autosave && !saver.is_busy()) {
+      save_to_file(DEFAULT_AUTOSAVE_MAP_FILE);
+      has_changes_since_autosave = false;
     }
   }
 
   void draw() {
-    // Background.
-    background.draw({0.f, 0.f}, pixel_size);
-
-    // Tiles.
-    for (auto const& [k, v] : tiles) v.draw(k.scale(pixel_size).to_vector2(), pixel_size);
-    DrawTexturePro(
-        *asset_manager.textures[TextureNames::Character1__Example],
-        {0.f, 0.f, static_cast<float>(asset_manager.textures[TextureNames::Character1__Example]->width),
-         static_cast<float>(asset_manager.textures[TextureNames::Character1__Example]->height)},
-        {static_cast<float>(character_position.x * pixel_size), static_cast<float>(character_position.y * pixel_size),
-         static_cast<float>(asset_manager.textures[TextureNames::Character1__Example]->width) * pixel_size,
-         static_cast<float>(asset_manager.textures[TextureNames::Character1__Example]->height) * pixel_size},
-        vector_zero, 0.f, WHITE);
-
-    Vector2 mouse_pos = GetMousePosition();
-
-    if (CheckCollisionPointRec(mouse_pos, game_area())) {
+    Rectangle const view{visible_area()};
+
+    // Background and tiles.
+    chunk_cache.bake_visible(view, tiles, background_index, map_size());
+
+    BeginMode2D(camera);
+
+    chunk_cache.draw(view, map_size());
+
+    DrawTextureV(*asset_manager.textures[TextureNames::Character1__Example], character_position.to_vector2(), WHITE);
+
+    Vector2 mouse_pos = map_pos(GetMousePosition());
+
+    if (CheckCollisionPointRec(mouse_pos, map_area())) {
       if (special_operation == SpecialOperation::Nothing) {
-        tile_selection.draw({static_cast<float>(mod_reduced(mouse_pos.x, tile_selection.snap() * pixel_size)),
-                             static_cast<float>(mod_reduced(mouse_pos.y, tile_selection.snap() * pixel_size))},
-                            pixel_size);
+        tile_selection.draw({static_cast<float>(mod_reduced(static_cast<int>(mouse_pos.x), tile_selection.snap())),
+                             static_cast<float>(mod_reduced(static_cast<int>(mouse_pos.y), tile_selection.snap()))},
+                            1);
       }
     }
 
+    if (active_interactive_group >= 0 && active_interactive_group < static_cast<int>(interactive_groups.size())) {
+      for (auto const& elem_pos : interactive_groups[active_interactive_group].get_elems()) {
+        TileSelection const* selection = tiles.get(elem_pos);
+        if (selection) DrawRectangleLinesEx(selection->hitbox(elem_pos), 1.f, ORANGE);
+      }
+    }
+
+    EndMode2D();
+
     draw_gui();
   }
 
   void unload() {
-    background.unload();
+    chunk_cache.unload();
     const char** group_list_names_raw = group_list_names.data();
     for (int i = 0; i < static_cast<int>(group_list_names.size()); i++) {
       char* word = const_cast<char*>(group_list_names_raw[i]);
@@ -187,9 +148,18 @@ struct Editor {
   }
 
  private:
-  Background background{};
+  EditorChunkCache chunk_cache{};
+  // Zoom is `pixel_size * zoom`, so world units are unscaled map pixels.
+  Camera2D camera{};
+  float zoom{1.f};
+  int background_index{0};
+  LevelSaver saver{};
+  TextureReloader texture_reloader{};
+  RepeatTimer autosave_timer{EDITOR_AUTOSAVE_INTERVAL};
+  bool is_autosave_enabled{true};
+  bool has_changes_since_autosave{false};
   TileSelection tile_selection{TileSource::Gui, {0, 0}};
-  std::unordered_map<IntVec2, TileSelection> tiles{};
+  TileIndex tiles{};
   int tile_width{32};
   int tile_height{20};
   int pixel_size{DEFAULT_PIXEL_SIZE};
@@ -200,28 +170,55 @@ struct Editor {
 
   void reset() {
     tiles.clear();
+    chunk_cache.mark_all_dirty();
+    has_changes_since_autosave = true;
   }
 
-  void export_to_file() {
-    const char* filename{"assets/maps/map.mp"};
+  void paint_tile(IntVec2 const pos) {
+    TileSelection const* old_selection = tiles.get(pos);
+    if (old_selection) chunk_cache.mark_dirty(tile_bounds(pos, *old_selection));
 
-    FILE* file = std::fopen(filename, "w");
-    if (!file) {
-      TraceLog(LOG_ERROR, "Cannot create map file");
-      return;
-    }
+    tiles.set(pos, tile_selection);
+    chunk_cache.mark_dirty(tile_bounds(pos, tile_selection));
+    has_changes_since_autosave = true;
+  }
 
-    int values[4] = {tile_width, tile_height, background.get_current_index(), static_cast<int>(tiles.size())};
-    fwrite(values, sizeof(int), 4, file);
+  void update_camera() {
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0.f && !ImGui::GetIO().WantCaptureMouse) {
+      // Zoom around the cursor.
+      Vector2 screen_pos = GetMousePosition();
+      camera.target = GetScreenToWorld2D(screen_pos, camera);
+      camera.offset = screen_pos;
+      zoom = std::clamp(zoom * powf(EDITOR_ZOOM_STEP, wheel), EDITOR_MIN_ZOOM, EDITOR_MAX_ZOOM);
+    }
 
-    character_position.write(file);
+    camera.zoom = pixel_size * zoom;
 
-    for (auto const& [k, v] : tiles) {
-      k.write(file);
-      v.write(file);
+    if (!ImGui::GetIO().WantCaptureKeyboard) {
+      float step = EDITOR_PAN_SPEED * GetFrameTime() / camera.zoom;
+      if (IsKeyDown(KEY_LEFT)) camera.target.x -= step;
+      if (IsKeyDown(KEY_RIGHT)) camera.target.x += step;
+      if (IsKeyDown(KEY_UP)) camera.target.y -= step;
+      if (IsKeyDown(KEY_DOWN)) camera.target.y += step;
     }
+  }
+
+  /**
+   * Copy of the level as it is now. Cheap next to serializing it, which happens on the saver thread.
+   */
+  LevelBlueprint snapshot() const {
+    LevelBlueprint blueprint{tile_width, tile_height, background_index, character_position};
 
-    std::fclose(file);
+    blueprint.tiles.reserve(tiles.size());
+    for (auto const& [pos, selection] : tiles) blueprint.tiles.push_back(LevelTile{pos, selection});
+    blueprint.interactive_groups = interactive_groups;
+
+    return blueprint;
+  }
+
+  void save_to_file(const char* filename) {
+    saver.save(filename, snapshot());
   }
 
   void draw_gui() {
@@ -236,9 +233,9 @@ struct Editor {
 
     draw_gui_pane_core();
     draw_gui_pane_walls();
-    draw_gui_pane_boxes();
-    draw_gui_pane_enemies();
-    draw_gui_pane_traps();
+    draw_gui_pane_tile_buttons("Boxes", TilePalette::Boxes);
+    draw_gui_pane_tile_buttons("Enemies", TilePalette::Enemies);
+    draw_gui_pane_tile_buttons("Traps", TilePalette::Traps);
     draw_gui_pane_groups();
 
     ImGui::End();
@@ -247,199 +244,102 @@ struct Editor {
   }
 
   void draw_gui_pane_core() {
-    bool bgr_need_redraw{false};
-    static int new_background_tile_index{0};
+    bool need_rebake{false};
 
     if (ImGui::CollapsingHeader("Core")) {
-      bgr_need_redraw |= ImGui::SliderInt("Pixel size", &pixel_size, 1, 12);
-      bgr_need_redraw |= ImGui::SliderInt("Tile width", &tile_width, 16, 64);
-      bgr_need_redraw |= ImGui::SliderInt("Tile height", &tile_height, 16, 64);
-      bgr_need_redraw |= ImGui::SliderInt("Background tile", &new_background_tile_index, 0, 5);
-
-      if (bgr_need_redraw) background.preload(new_background_tile_index, tile_width, tile_height, pixel_size);
+      ImGui::SliderInt("Pixel size", &pixel_size, 1, 12);
+      ImGui::SliderFloat("Zoom", &zoom, EDITOR_MIN_ZOOM, EDITOR_MAX_ZOOM);
+      need_rebake |= ImGui::SliderInt("Tile width", &tile_width, 16, EDITOR_MAX_TILE_COUNT);
+      need_rebake |= ImGui::SliderInt("Tile height", &tile_height, 16, EDITOR_MAX_TILE_COUNT);
+      need_rebake |= ImGui::SliderInt("Background tile", &background_index, 0, BACKGROUND_COUNT - 1);
+
+      if (need_rebake) {
+        chunk_cache.mark_all_dirty();
+        has_changes_since_autosave = true;
+      }
 
       ImGui::Separator();
 
       if (ImGui::Button("Reset editor")) reset();
       ImGui::SameLine();
-      if (ImGui::Button("Save")) export_to_file();
-    }
-  }
-
-  void draw_gui_pane_walls() {
-    if (ImGui::CollapsingHeader("Walls")) {
-      rlImGuiImageSize(&*asset_manager.textures[TextureNames::GuiTiles],
-                       asset_manager.textures[TextureNames::GuiTiles]->width * fixed_pixel_size,
-                       asset_manager.textures[TextureNames::GuiTiles]->height * fixed_pixel_size);
-
-      // Detect mouse click on the image
-      if (ImGui::IsItemClicked()) {
-        ImVec2 mousePos = ImGui::GetMousePos();
-        ImVec2 itemRectMin = ImGui::GetItemRectMin();
-        ImVec2 relativePos = {mousePos.x - itemRectMin.x, mousePos.y - itemRectMin.y};
-
-        // TraceLog(LOG_INFO, "%.2f - %.2f", relativePos.x, relativePos.y);
-        tile_selection = TileSelection{TileSource::Gui,
-                                       {static_cast<int>(relativePos.x) / (TILE_SIZE * fixed_pixel_size),
-                                        static_cast<int>(relativePos.y) / (TILE_SIZE * fixed_pixel_size)}};
-      }
-
-      ImGui::Separator();
+      if (ImGui::Button("Save")) save_to_file(DEFAULT_MAP_FILE);
+      ImGui::SameLine();
+      ImGui::Checkbox("Autosave", &is_autosave_enabled);
 
-      rlImGuiImageSize(&*asset_manager.textures[TextureNames::TilesetTiles],
-                       asset_manager.textures[TextureNames::TilesetTiles]->width * fixed_pixel_size,
-                       asset_manager.textures[TextureNames::TilesetTiles]->height * fixed_pixel_size);
-
-      // Detect mouse click on the image
-      if (ImGui::IsItemClicked()) {
-        ImVec2 mousePos = ImGui::GetMousePos();
-        ImVec2 itemRectMin = ImGui::GetItemRectMin();
-        ImVec2 relativePos = {mousePos.x - itemRectMin.x, mousePos.y - itemRectMin.y};
-
-        tile_selection = TileSelection{TileSource::Tileset,
-                                       {static_cast<int>(relativePos.x) / (TILE_SIZE * fixed_pixel_size),
-                                        static_cast<int>(relativePos.y) / (TILE_SIZE * fixed_pixel_size)}};
-        TraceLog(LOG_INFO, "Tileset: %d:%d", static_cast<int>(relativePos.x) / (TILE_SIZE * fixed_pixel_size),
-                 static_cast<int>(relativePos.y) / (TILE_SIZE * fixed_pixel_size));
+      if (saver.is_busy()) {
+        ImGui::ProgressBar(saver.get_progress());
+      } else if (saver.get_completed_count() > 0) {
+        ImGui::Text("Last save: %s in %.1f ms", saver.get_last_result() ? "done" : "FAILED",
+                    saver.get_last_latency_ms());
       }
     }
   }
 
-  void draw_gui_pane_boxes() {
-    if (ImGui::CollapsingHeader("Boxes")) {
-      if (rlImGuiImageButtonSize(
-              "Box1", &*asset_manager.textures[TextureNames::Box1__Idle],
-              {static_cast<float>(asset_manager.textures[TextureNames::Box1__Idle]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Box1__Idle]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Box1, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Box2", &*asset_manager.textures[TextureNames::Box2__Idle],
-              {static_cast<float>(asset_manager.textures[TextureNames::Box2__Idle]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Box2__Idle]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Box2, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Box3", &*asset_manager.textures[TextureNames::Box3__Idle],
-              {static_cast<float>(asset_manager.textures[TextureNames::Box3__Idle]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Box3__Idle]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Box3, {0, 0}};
+  void draw_gui_pane_walls() {
+    if (ImGui::CollapsingHeader("Walls")) {
+      bool is_first{true};
+      for (TileKind const& kind : TILE_KINDS) {
+        if (kind.palette != TilePalette::Walls) continue;
+
+        if (!is_first) ImGui::Separator();
+        is_first = false;
+
+        std::shared_ptr<Texture2D> const& texture = asset_manager.textures[kind.palette_texture];
+        rlImGuiImageSize(&*texture, texture->width * fixed_pixel_size, texture->height * fixed_pixel_size);
+
+        // Detect mouse click on the image
+        if (ImGui::IsItemClicked()) {
+          ImVec2 mousePos = ImGui::GetMousePos();
+          ImVec2 itemRectMin = ImGui::GetItemRectMin();
+          ImVec2 relativePos = {mousePos.x - itemRectMin.x, mousePos.y - itemRectMin.y};
+
+          tile_selection = TileSelection{kind.source,
+                                         {static_cast<int>(relativePos.x) / (TILE_SIZE * fixed_pixel_size),
+                                          static_cast<int>(relativePos.y) / (TILE_SIZE * fixed_pixel_size)}};
+          TraceLog(LOG_INFO, "%s: %d:%d", kind.name, tile_selection.tile_coord.x, tile_selection.tile_coord.y);
+        }
       }
     }
   }
 
-  void draw_gui_pane_enemies() {
-    if (ImGui::CollapsingHeader("Enemies")) {
-      if (rlImGuiImageButtonSize(
-              "Enemy1", &*asset_manager.textures[TextureNames::Enemy1__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Enemy1__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Enemy1__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Enemy1, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Enemy2", &*asset_manager.textures[TextureNames::Enemy2__Fall],
-              {static_cast<float>(asset_manager.textures[TextureNames::Enemy2__Fall]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Enemy2__Fall]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Enemy2, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Enemy3", &*asset_manager.textures[TextureNames::Enemy3__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Enemy3__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Enemy3__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Enemy3, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Enemy4", &*asset_manager.textures[TextureNames::Enemy4__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Enemy4__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Enemy4__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Enemy4, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Enemy5", &*asset_manager.textures[TextureNames::Enemy5__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Enemy5__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Enemy5__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Enemy5, {0, 0}};
+  /**
+   * One image button per tile kind of `palette`, in `TileSource` order.
+   */
+  void draw_gui_pane_tile_buttons(char const* header, TilePalette const palette) {
+    if (ImGui::CollapsingHeader(header)) {
+      bool is_first{true};
+      for (TileKind const& kind : TILE_KINDS) {
+        if (kind.palette != palette) continue;
+
+        if (!is_first) ImGui::SameLine();
+        is_first = false;
+
+        std::shared_ptr<Texture2D> const& texture = asset_manager.textures[kind.palette_texture];
+        if (rlImGuiImageButtonSize(kind.name, &*texture,
+                                   {static_cast<float>(texture->width * fixed_pixel_size),
+                                    static_cast<float>(texture->height * fixed_pixel_size)})) {
+          tile_selection = TileSelection{kind.source, {0, 0}};
+        }
       }
     }
   }
 
-  void draw_gui_pane_traps() {
-    if (ImGui::CollapsingHeader("Traps")) {
-      if (rlImGuiImageButtonSize(
-              "Trap1", &*asset_manager.textures[TextureNames::Trap1__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Trap1__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Trap1__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Trap1, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Trap2", &*asset_manager.textures[TextureNames::Trap2__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Trap2__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Trap2__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Trap2, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Trap4", &*asset_manager.textures[TextureNames::Trap4__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Trap4__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Trap4__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Trap4, {0, 0}};
-      }
-
-      ImGui::SameLine();
-
-      if (rlImGuiImageButtonSize(
-              "Trap5", &*asset_manager.textures[TextureNames::Trap5__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Trap5__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Trap5__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Trap5, {0, 0}};
-      }
-
-      ImGui::SameLine();
+  void sync_group_list_names() {
+    char group_name_buf[16]{};
 
-      if (rlImGuiImageButtonSize(
-              "Trap6", &*asset_manager.textures[TextureNames::Trap6__Example],
-              {static_cast<float>(asset_manager.textures[TextureNames::Trap6__Example]->width * fixed_pixel_size),
-               static_cast<float>(asset_manager.textures[TextureNames::Trap6__Example]->height * fixed_pixel_size)})) {
-        tile_selection = TileSelection{TileSource::Trap6, {0, 0}};
-      }
+    while (interactive_groups.size() > group_list_names.size()) {
+      sprintf(group_name_buf, "Group %lu", group_list_names.size());
+      char* new_group_name = strdup(group_name_buf);
+      group_list_names.push_back(new_group_name);
     }
   }
 
   void draw_gui_pane_groups() {
-    char group_name_buf[16]{};
-
     if (ImGui::CollapsingHeader("Group Management")) {
       if (ImGui::Button("+ New group")) {
         interactive_groups.emplace_back();
-
-        while (interactive_groups.size() > group_list_names.size()) {
-          sprintf(group_name_buf, "Group %lu", group_list_names.size());
-          char* new_group_name = strdup(group_name_buf);
-          group_list_names.push_back(new_group_name);
-        }
+        sync_group_list_names();
+        has_changes_since_autosave = true;
       }
 
       ImGui::Separator();
@@ -457,36 +357,37 @@ struct Editor {
         return;
       }
 
-      for (auto const& elem_pos : interactive_groups[active_interactive_group].get_elems()) {
-        auto const& tile_selection = tiles[elem_pos];
-        DrawRectangleLinesEx(tile_selection.hitbox(elem_pos, pixel_size), pixel_size, ORANGE);
-      }
-
       if (ImGui::Button("Add elem")) {
         special_operation = SpecialOperation::GroupElemSelect;
       }
 
       ImGui::Separator();
 
-      const char* behaviour_names[] = {"Horizontal movement", "Vertical movement"};
+      // Same order as `ObjectBehaviourType`.
+      const char* behaviour_names[] = {"Vertical movement", "Horizontal movement"};
       static int selected_behaviour{0};
       ImGui::Combo("Behaviour", &selected_behaviour, behaviour_names, IM_ARRAYSIZE(behaviour_names));
       if (ImGui::Button("Add behaviour")) {
         interactive_groups[active_interactive_group].add_behaviour(
             static_cast<ObjectBehaviourType>(selected_behaviour));
+        has_changes_since_autosave = true;
       }
 
       for (auto& behaviour : interactive_groups[active_interactive_group].get_behaviours()) {
         switch (behaviour.type) {
           case ObjectBehaviourType::HorizontalMovement:
             ImGui::Text("Behaviour: horizontal movement");
-            ImGui::SliderInt("Left limit", &behaviour.movement_range.x, 0, GetScreenWidth());
-            ImGui::SliderInt("Right limit", &behaviour.movement_range.y, 0, GetScreenWidth());
+            has_changes_since_autosave |=
+                ImGui::SliderInt("Left limit", &behaviour.movement_range.x, 0, tile_width * TILE_SIZE);
+            has_changes_since_autosave |=
+                ImGui::SliderInt("Right limit", &behaviour.movement_range.y, 0, tile_width * TILE_SIZE);
             break;
           case ObjectBehaviourType::VerticalMovement:
             ImGui::Text("Behaviour: vertical movement");
-            ImGui::SliderInt("Top limit", &behaviour.movement_range.x, 0, GetScreenWidth());
-            ImGui::SliderInt("Bottom limit", &behaviour.movement_range.y, 0, GetScreenWidth());
+            has_changes_since_autosave |=
+                ImGui::SliderInt("Top limit", &behaviour.movement_range.x, 0, tile_height * TILE_SIZE);
+            has_changes_since_autosave |=
+                ImGui::SliderInt("Bottom limit", &behaviour.movement_range.y, 0, tile_height * TILE_SIZE);
             break;
           default:
             BAIL;
@@ -495,8 +396,23 @@ struct Editor {
     }
   }
 
-  Rectangle const game_area() const {
-    return {0.f, 0.f, static_cast<float>(TILE_SIZE * tile_width * pixel_size),
-            static_cast<float>(TILE_SIZE * tile_height * pixel_size)};
+  // Screen position to unscaled map pixels.
+  Vector2 map_pos(Vector2 const screen_pos) const {
+    return GetScreenToWorld2D(screen_pos, camera);
+  }
+
+  IntVec2 map_size() const {
+    return IntVec2{TILE_SIZE * tile_width, TILE_SIZE * tile_height};
+  }
+
+  Rectangle const map_area() const {
+    return {0.f, 0.f, static_cast<float>(TILE_SIZE * tile_width), static_cast<float>(TILE_SIZE * tile_height)};
+  }
+
+  // Part of the map on screen, in unscaled map pixels.
+  Rectangle visible_area() const {
+    Vector2 top_left{map_pos(vector_zero)};
+    Vector2 bottom_right{map_pos({static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight())})};
+    return Rectangle{top_left.x, top_left.y, bottom_right.x - top_left.x, bottom_right.y - top_left.y};
   }
 };
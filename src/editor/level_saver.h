@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../level.h"
+#include "raylib.h"
+
+struct LevelSaveJob {
+  std::string filename;
+  LevelBlueprint blueprint;
+};
+
+/**
+ * Serializes and writes level snapshots on a worker thread, so saving never blocks the editor frame. A request made
+ * while a save runs replaces any still pending one.
+ */
+struct LevelSaver {
+ public:
+  LevelSaver() : worker([this]() { run(); }) {
+  }
+
+  ~LevelSaver() {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      should_stop = true;
+    }
+    has_work.notify_one();
+    worker.join();
+  }
+
+  void save(std::string filename, LevelBlueprint&& blueprint) {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      pending_job = LevelSaveJob{std::move(filename), std::move(blueprint)};
+      is_busy_flag = true;
+    }
+    has_work.notify_one();
+  }
+
+  bool is_busy() const {
+    return is_busy_flag;
+  }
+
+  float get_progress() const {
+    return progress;
+  }
+
+  float get_last_latency_ms() const {
+    return last_latency_ms;
+  }
+
+  bool get_last_result() const {
+    return last_result;
+  }
+
+  int get_completed_count() const {
+    return completed_count;
+  }
+
+ private:
+  std::mutex mutex{};
+  std::condition_variable has_work{};
+  std::optional<LevelSaveJob> pending_job{};
+  bool should_stop{false};
+
+  std::atomic<bool> is_busy_flag{false};
+  std::atomic<float> progress{0.f};
+  std::atomic<float> last_latency_ms{0.f};
+  std::atomic<bool> last_result{true};
+  std::atomic<int> completed_count{0};
+
+  // Last member, the thread must start after the state above is initialized.
+  std::thread worker;
+
+  void run() {
+    std::vector<char> buffer{};
+
+    while (true) {
+      LevelSaveJob job{};
+      {
+        std::unique_lock<std::mutex> lock{mutex};
+        has_work.wait(lock, [this]() { return should_stop || pending_job.has_value(); });
+        if (!pending_job.has_value()) return;
+
+        job = std::move(*pending_job);
+        pending_job.reset();
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      progress = 0.f;
+
+      // Serialization is most of the work, the write gets the last 10%.
+      level_blueprint_to_buffer(job.blueprint, &buffer, [this](float done) { progress = done * 0.9f; });
+      bool result = write_file_atomically(job.filename.c_str(), buffer);
+
+      progress = 1.f;
+      last_result = result;
+      last_latency_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+      completed_count++;
+
+      if (result) TraceLog(LOG_INFO, "Saved %s in %.1f ms", job.filename.c_str(), last_latency_ms.load());
+
+      std::lock_guard<std::mutex> lock{mutex};
+      if (!pending_job.has_value()) is_busy_flag = false;
+    }
+  }
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include "../common.h"
+#include "raylib.h"
+
+// Bucket edge in unscaled map pixels. Larger than any tile, so a tile lives in at most 4 buckets.
+constexpr int const TILE_INDEX_CELL_SIZE{TILE_SIZE * 4};
+
+/**
+ * Area a tile touches in unscaled map pixels: its drawn frame and its hitbox.
+ */
+Rectangle tile_bounds(IntVec2 const pos, TileSelection const& selection) {
+  Rectangle hitbox{selection.hitbox(pos)};
+  IntVec2 size{selection.tile_size()};
+  float min_x = std::min(hitbox.x, static_cast<float>(pos.x));
+  float min_y = std::min(hitbox.y, static_cast<float>(pos.y));
+  float max_x = std::max(hitbox.x + hitbox.width, static_cast<float>(pos.x + size.x));
+  float max_y = std::max(hitbox.y + hitbox.height, static_cast<float>(pos.y + size.y));
+  return Rectangle{min_x, min_y, max_x - min_x, max_y - min_y};
+}
+
+/**
+ * Editor tiles keyed by their unscaled map position, with a uniform grid over their bounds so point and area queries
+ * only test the tiles of the touched buckets.
+ */
+struct TileIndex {
+ public:
+  using TileMap = std::unordered_map<IntVec2, TileSelection>;
+
+  void clear() {
+    tiles.clear();
+    buckets.clear();
+  }
+
+  void set(IntVec2 const pos, TileSelection const& selection) {
+    auto it = tiles.find(pos);
+    if (it != tiles.end()) {
+      if (it->second.source == selection.source && it->second.tile_coord == selection.tile_coord) return;
+
+      unregister_tile(pos, it->second);
+      it->second = selection;
+    } else {
+      tiles.emplace(pos, selection);
+    }
+
+    register_tile(pos, selection);
+  }
+
+  bool erase(IntVec2 const pos) {
+    auto it = tiles.find(pos);
+    if (it == tiles.end()) return false;
+
+    unregister_tile(pos, it->second);
+    tiles.erase(it);
+    return true;
+  }
+
+  /**
+   * Removes every tile whose hitbox contains `point` (unscaled map pixels), calling `on_erase(pos, selection)` before
+   * each removal. Returns the number of removed tiles.
+   */
+  template <typename F>
+  size_t erase_at(Vector2 const point, F&& on_erase) {
+    auto bucket_it = buckets.find(cell_of(point));
+    if (bucket_it == buckets.end()) return 0;
+
+    // Matches are collected first, `erase` edits and may drop the bucket.
+    std::vector<IntVec2> matches{};
+    for (auto const& pos : bucket_it->second) {
+      if (CheckCollisionPointRec(point, tiles.at(pos).hitbox(pos))) matches.push_back(pos);
+    }
+
+    for (auto const& pos : matches) {
+      on_erase(pos, tiles.at(pos));
+      erase(pos);
+    }
+    return matches.size();
+  }
+
+  size_t erase_at(Vector2 const point) {
+    return erase_at(point, [](IntVec2 const, TileSelection const&) {});
+  }
+
+  /**
+   * Calls `f(pos, selection)` once for every tile whose bounds overlap `region` (unscaled map pixels).
+   */
+  template <typename F>
+  void for_each_in(Rectangle const& region, F&& f) const {
+    IntVec2 region_min{cell_coord(region.x), cell_coord(region.y)};
+
+    for_each_cell(region, [&](IntVec2 const cell) {
+      auto bucket_it = buckets.find(cell);
+      if (bucket_it == buckets.end()) return;
+
+      for (auto const& pos : bucket_it->second) {
+        TileSelection const& selection = tiles.at(pos);
+        Rectangle bounds{tile_bounds(pos, selection)};
+
+        // Only report the tile from the first bucket it shares with the region.
+        IntVec2 first_cell{std::max(cell_coord(bounds.x), region_min.x), std::max(cell_coord(bounds.y), region_min.y)};
+        if (!(first_cell == cell)) continue;
+
+        if (CheckCollisionRecs(bounds, region)) f(pos, selection);
+      }
+    });
+  }
+
+  /**
+   * Position of a tile whose hitbox contains `point` (unscaled map pixels).
+   */
+  bool find_at(Vector2 const point, IntVec2* out) const {
+    auto bucket_it = buckets.find(cell_of(point));
+    if (bucket_it == buckets.end()) return false;
+
+    for (auto const& pos : bucket_it->second) {
+      if (CheckCollisionPointRec(point, tiles.at(pos).hitbox(pos))) {
+        *out = pos;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  TileSelection const* get(IntVec2 const pos) const {
+    auto it = tiles.find(pos);
+    return it == tiles.end() ? nullptr : &it->second;
+  }
+
+  size_t size() const {
+    return tiles.size();
+  }
+
+  TileMap::const_iterator begin() const {
+    return tiles.begin();
+  }
+
+  TileMap::const_iterator end() const {
+    return tiles.end();
+  }
+
+ private:
+  TileMap tiles{};
+  std::unordered_map<IntVec2, std::vector<IntVec2>> buckets{};
+
+  static int cell_coord(float v) {
+    return static_cast<int>(std::floor(v / TILE_INDEX_CELL_SIZE));
+  }
+
+  static IntVec2 cell_of(Vector2 const point) {
+    return IntVec2{cell_coord(point.x), cell_coord(point.y)};
+  }
+
+  template <typename F>
+  static void for_each_cell(Rectangle const& hitbox, F&& f) {
+    int min_x = cell_coord(hitbox.x);
+    int min_y = cell_coord(hitbox.y);
+    int max_x = cell_coord(hitbox.x + hitbox.width);
+    int max_y = cell_coord(hitbox.y + hitbox.height);
+
+    for (int y = min_y; y <= max_y; y++) {
+      for (int x = min_x; x <= max_x; x++) f(IntVec2{x, y});
+    }
+  }
+
+  void register_tile(IntVec2 const pos, TileSelection const& selection) {
+    for_each_cell(tile_bounds(pos, selection), [&](IntVec2 const cell) { buckets[cell].push_back(pos); });
+  }
+
+  void unregister_tile(IntVec2 const pos, TileSelection const& selection) {
+    for_each_cell(tile_bounds(pos, selection), [&](IntVec2 const cell) {
+      auto bucket_it = buckets.find(cell);
+      if (bucket_it == buckets.end()) return;
+
+      std::vector<IntVec2>& bucket = bucket_it->second;
+      auto it = std::find(bucket.begin(), bucket.end(), pos);
+      if (it != bucket.end()) {
+        *it = bucket.back();
+        bucket.pop_back();
+      }
+      if (bucket.empty()) buckets.erase(bucket_it);
+    });
+  }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "raylib.h"
+
+/**
+ * Writes `buffer` next to `filename`, syncs it and renames it over `filename`, so readers see either the old or the new
+ * file, never a partial one.
+ */
+bool write_file_atomically(const char* filename, std::vector<char> const& buffer) {
+  std::string temp_filename{std::string{filename} + ".tmp"};
+
+  FILE* file = std::fopen(temp_filename.c_str(), "wb");
+  if (!file) {
+    TraceLog(LOG_ERROR, "Cannot create file: %s", temp_filename.c_str());
+    return false;
+  }
+
+  bool is_ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+  is_ok &= std::fflush(file) == 0;
+  is_ok &= fsync(fileno(file)) == 0;
+  is_ok &= std::fclose(file) == 0;
+
+  if (!is_ok || std::rename(temp_filename.c_str(), filename) != 0) {
+    TraceLog(LOG_ERROR, "Cannot write file: %s", filename);
+    std::remove(temp_filename.c_str());
+    return false;
+  }
+
+  return true;
+}
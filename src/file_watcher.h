@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "raylib.h"
+
+struct WatchedFile {
+  std::string path;
+  std::string dir;
+  std::string name;
+  int watch_descriptor{-1};
+  // Used when inotify is not available.
+  std::filesystem::file_time_type last_write_time{};
+};
+
+/**
+ * Reports files that were rewritten. On Linux it watches the parent directories with inotify, so both in-place writes
+ * and atomic renames over the file are seen. `poll` never blocks; call it once per frame.
+ */
+struct FileWatcher {
+ public:
+  FileWatcher() {
+#if defined(__linux__)
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) TraceLog(LOG_WARNING, "File watching is not available");
+#endif
+  }
+
+  ~FileWatcher() {
+#if defined(__linux__)
+    if (fd >= 0) close(fd);
+#endif
+  }
+
+  FileWatcher(FileWatcher const&) = delete;
+  FileWatcher& operator=(FileWatcher const&) = delete;
+
+  void watch(std::string const& path) {
+    std::filesystem::path fs_path{path};
+    WatchedFile file{path, fs_path.parent_path().string(), fs_path.filename().string()};
+    if (file.dir.empty()) file.dir = ".";
+
+#if defined(__linux__)
+    if (fd < 0) return;
+
+    file.watch_descriptor = inotify_add_watch(fd, file.dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (file.watch_descriptor < 0) {
+      TraceLog(LOG_WARNING, "Cannot watch: %s", file.dir.c_str());
+      return;
+    }
+#else
+    std::error_code error{};
+    file.last_write_time = std::filesystem::last_write_time(fs_path, error);
+#endif
+
+    files.push_back(std::move(file));
+  }
+
+  /**
+   * Appends the paths of the watched files changed since the last call to `changed`, each at most once.
+   */
+  void poll(std::vector<std::string>* changed) {
+#if defined(__linux__)
+    if (fd < 0) return;
+
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+      ssize_t len = read(fd, buffer, sizeof(buffer));
+      if (len <= 0) break;
+
+      for (ssize_t offset = 0; offset < len;) {
+        inotify_event const* event = reinterpret_cast<inotify_event const*>(buffer + offset);
+        offset += sizeof(inotify_event) + event->len;
+        if (event->len == 0) continue;
+
+        for (auto const& file : files) {
+          if (file.watch_descriptor != event->wd || file.name != event->name) continue;
+          if (std::find(changed->begin(), changed->end(), file.path) == changed->end()) changed->push_back(file.path);
+        }
+      }
+    }
+#else
+    for (auto& file : files) {
+      std::error_code error{};
+      auto write_time = std::filesystem::last_write_time(file.path, error);
+      if (error || write_time == file.last_write_time) continue;
+
+      file.last_write_time = write_time;
+      changed->push_back(file.path);
+    }
+#endif
+  }
+
+  /**
+   * Whether any watched file changed since the last call.
+   */
+  bool poll() {
+    changed_scratch.clear();
+    poll(&changed_scratch);
+    return !changed_scratch.empty();
+  }
+
+ private:
+  int fd{-1};
+  std::vector<WatchedFile> files{};
+  std::vector<std::string> changed_scratch{};
+};
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "animation.h"
 #include "asset_manager.h"
 #include "common.h"
+#include "particles.h"
 #include "raylib.h"
 #include "sprite.h"
 
@@ -11,8 +13,13 @@ struct InteractiveObject {
 
   virtual void draw() const = 0;
   virtual void update(Rectangle const& character_hitbox) = 0;
+  virtual void reset() = 0;
   virtual Rectangle const hitbox() const = 0;
+  // Area `hitbox()` stays inside in every state. The map indexes objects by it.
+  virtual Rectangle const bounds() const = 0;
   virtual int collision_directions() const = 0;
+  // Spawn position, identifies the object when the level is patched.
+  virtual Vector2 const position() const = 0;
 };
 
 enum class DisappearingPlankState {
@@ -22,15 +29,23 @@ enum class DisappearingPlankState {
   Gone,
 };
 
-struct DisappearingPlank : InteractiveObject {
+struct DisappearingPlank : InteractiveObject, AnimationListener {
  public:
   DisappearingPlank(int const pixel_size, Vector2 const pos) : pixel_size(pixel_size), pos(pos), sprite(pixel_size) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-    sprite.init_texture(asset_manager.textures[TextureNames::Trap5], SIMPLE_WALK_NPC_SIZE, 7, sprite_frame_length);
-    sprite.stop();
+    sprite.init_texture(asset_manager.textures[TextureNames::Trap5], SIMPLE_WALK_NPC_SIZE, 7, DEFAULT_FRAME_TICKS);
+    reset();
   }
 
-  ~DisappearingPlank() = default;
+  ~DisappearingPlank() {
+    animation_clock.cancel(this);
+  }
+
+  void reset() override {
+    animation_clock.cancel(this);
+    state = DisappearingPlankState::Solid;
+    sprite.reset();
+    sprite.stop();
+  }
 
   void draw() const override {
     if (state != DisappearingPlankState::Gone) sprite.draw(pos);
@@ -38,12 +53,6 @@ struct DisappearingPlank : InteractiveObject {
   }
 
   void update(Rectangle const& character_hitbox) override {
-    if (sprite.update() == 0) {
-      state = DisappearingPlankState::Gone;
-      timer.reset();
-      sprite.stop();
-    }
-
     if (state == DisappearingPlankState::Solid) {
       if (CheckCollisionRecs(character_hitbox, hitbox_upper_surface())) {
         timer.reset(1.0);
@@ -51,7 +60,8 @@ struct DisappearingPlank : InteractiveObject {
       }
     } else if (state == DisappearingPlankState::WaitForCrumbling) {
       if (timer.update()) {
-        sprite.play();
+        sprite.play_once(this, 0);
+        particles.emit(ParticleBurstCrumble, rect_center(hitbox()), pixel_size);
         timer.reset(4.0);
         state = DisappearingPlankState::Crumbling;
       }
@@ -66,18 +76,32 @@ struct DisappearingPlank : InteractiveObject {
     }
   }
 
+  void on_animation_end(int tag) override {
+    state = DisappearingPlankState::Gone;
+    timer.reset();
+    sprite.stop();
+  }
+
   Rectangle const hitbox() const override {
     if (state == DisappearingPlankState::Solid || state == DisappearingPlankState::WaitForCrumbling) {
-      return move(upscale(tile_source_hitbox(TileSource::Trap5), pixel_size), pos);
+      return bounds();
     } else {
       return OutsideRectangle;
     }
   }
 
+  Rectangle const bounds() const override {
+    return move(upscale(tile_source_hitbox(TileSource::Trap5), pixel_size), pos);
+  }
+
   int collision_directions() const override {
     return COLLISION_TYPE_TOP;
   }
 
+  Vector2 const position() const override {
+    return pos;
+  }
+
  private:
   int const pixel_size;
   Vector2 const pos;
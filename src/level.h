@@ -0,0 +1,289 @@
+#pragma once
+
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common.h"
+#include "file_util.h"
+#include "raylib.h"
+
+constexpr const char* DEFAULT_MAP_FILE{"assets/maps/map.mp"};
+constexpr const char* DEFAULT_AUTOSAVE_MAP_FILE{"assets/maps/map.autosave.mp"};
+
+template <typename T>
+void buffer_write(std::vector<char>* buffer, T const& value) {
+  char const* bytes = reinterpret_cast<char const*>(&value);
+  buffer->insert(buffer->end(), bytes, bytes + sizeof(T));
+}
+
+void buffer_write(std::vector<char>* buffer, IntVec2 const& v) {
+  buffer_write(buffer, v.x);
+  buffer_write(buffer, v.y);
+}
+
+struct LevelTile {
+  IntVec2 pos{};
+  TileSelection selection{};
+};
+
+enum class ObjectBehaviourType {
+  VerticalMovement,
+  HorizontalMovement,
+};
+
+/**
+ * Movement behaviours keep the group's top-left corner between `movement_range.x` and `movement_range.y` (unscaled map
+ * pixels) on their axis.
+ */
+struct ObjectBehaviour {
+  ObjectBehaviourType type;
+  union {
+    IntVec2 movement_range;
+  };
+};
+
+ObjectBehaviour make_object_behaviour__vertical_movement() {
+  return ObjectBehaviour{ObjectBehaviourType::VerticalMovement, IntVec2{0, 0}};
+}
+
+ObjectBehaviour make_object_behaviour__horizontal_movement() {
+  return ObjectBehaviour{ObjectBehaviourType::HorizontalMovement, IntVec2{0, 0}};
+}
+
+struct InteractiveGroup {
+ public:
+  void add_elem(IntVec2 const coord) {
+    elems.push_back(coord);
+  }
+
+  std::vector<IntVec2> const& get_elems() const {
+    return elems;
+  }
+
+  std::vector<ObjectBehaviour>& get_behaviours() {
+    return behaviours;
+  }
+
+  std::vector<ObjectBehaviour> const& get_behaviours() const {
+    return behaviours;
+  }
+
+  void add_behaviour(ObjectBehaviourType type) {
+    switch (type) {
+      case ObjectBehaviourType::HorizontalMovement:
+        behaviours.push_back(make_object_behaviour__horizontal_movement());
+        break;
+      case ObjectBehaviourType::VerticalMovement:
+        behaviours.push_back(make_object_behaviour__vertical_movement());
+        break;
+      default:
+        BAIL;
+        break;
+    }
+  }
+
+  bool operator==(InteractiveGroup const& other) const {
+    if (elems != other.elems || behaviours.size() != other.behaviours.size()) return false;
+
+    for (size_t i = 0; i < behaviours.size(); i++) {
+      if (behaviours[i].type != other.behaviours[i].type) return false;
+      if (!(behaviours[i].movement_range == other.behaviours[i].movement_range)) return false;
+    }
+    return true;
+  }
+
+  void write(std::vector<char>* buffer) const {
+    buffer_write(buffer, static_cast<int>(elems.size()));
+    for (auto const& elem : elems) buffer_write(buffer, elem);
+
+    buffer_write(buffer, static_cast<int>(behaviours.size()));
+    for (auto const& behaviour : behaviours) {
+      buffer_write(buffer, static_cast<int>(behaviour.type));
+      buffer_write(buffer, behaviour.movement_range);
+    }
+  }
+
+ private:
+  std::vector<IntVec2> elems{};
+  std::vector<ObjectBehaviour> behaviours{};
+};
+
+/**
+ * Empty when the file ends early or holds an unknown behaviour.
+ */
+std::optional<InteractiveGroup> interactive_group_from_file(FILE* file) {
+  InteractiveGroup group{};
+
+  int elems_count{};
+  if (std::fread(&elems_count, sizeof(int), 1, file) != 1) return std::nullopt;
+  for (int i = 0; i < elems_count; i++) {
+    std::optional<IntVec2> elem{intvec2_from_file(file)};
+    if (!elem.has_value()) return std::nullopt;
+    group.add_elem(*elem);
+  }
+
+  int behaviours_count{};
+  if (std::fread(&behaviours_count, sizeof(int), 1, file) != 1) return std::nullopt;
+  for (int i = 0; i < behaviours_count; i++) {
+    int type_raw{};
+    if (std::fread(&type_raw, sizeof(int), 1, file) != 1) return std::nullopt;
+
+    switch (type_raw) {
+      case 0:
+        group.add_behaviour(ObjectBehaviourType::VerticalMovement);
+        break;
+      case 1:
+        group.add_behaviour(ObjectBehaviourType::HorizontalMovement);
+        break;
+      default:
+        TraceLog(LOG_WARNING, "Invalid behaviour: %d", type_raw);
+        return std::nullopt;
+    }
+
+    std::optional<IntVec2> movement_range{intvec2_from_file(file)};
+    if (!movement_range.has_value()) return std::nullopt;
+    group.get_behaviours().back().movement_range = *movement_range;
+  }
+
+  return group;
+}
+
+/**
+ * Parsed, immutable description of a level. Built once from the map file and used to (re)spawn the world without
+ * touching the disk again.
+ */
+struct LevelBlueprint {
+  int tile_width{};
+  int tile_height{};
+  int background_index{};
+  IntVec2 character_position{};
+  std::vector<LevelTile> tiles{};
+  std::vector<InteractiveGroup> interactive_groups{};
+};
+
+std::optional<LevelBlueprint> level_blueprint_from_open_file(FILE* file) {
+  LevelBlueprint blueprint{};
+  int tiles_count{};
+
+  if (std::fread(&blueprint.tile_width, sizeof(int), 1, file) != 1) return std::nullopt;
+  if (std::fread(&blueprint.tile_height, sizeof(int), 1, file) != 1) return std::nullopt;
+  if (std::fread(&blueprint.background_index, sizeof(int), 1, file) != 1) return std::nullopt;
+  if (std::fread(&tiles_count, sizeof(int), 1, file) != 1) return std::nullopt;
+  if (blueprint.tile_width <= 0 || blueprint.tile_height <= 0 || tiles_count < 0) return std::nullopt;
+
+  std::optional<IntVec2> character_position{intvec2_from_file(file)};
+  if (!character_position.has_value()) return std::nullopt;
+  blueprint.character_position = *character_position;
+
+  for (int i = 0; i < tiles_count; i++) {
+    std::optional<IntVec2> tile_pos{intvec2_from_file(file)};
+    if (!tile_pos.has_value()) return std::nullopt;
+    std::optional<TileSelection> tile_selection{tile_selection_from_file(file)};
+    if (!tile_selection.has_value()) return std::nullopt;
+    blueprint.tiles.push_back(LevelTile{*tile_pos, *tile_selection});
+  }
+
+  // Optional section, older maps end after the tiles.
+  int groups_count{};
+  if (std::fread(&groups_count, sizeof(int), 1, file) == 1) {
+    for (int i = 0; i < groups_count; i++) {
+      std::optional<InteractiveGroup> group{interactive_group_from_file(file)};
+      if (!group.has_value()) return std::nullopt;
+      blueprint.interactive_groups.push_back(std::move(*group));
+    }
+  }
+
+  return blueprint;
+}
+
+/**
+ * Empty, with a warning logged, when the file is missing, truncated or malformed (e.g. caught mid-write). Safe to call
+ * from worker threads.
+ */
+std::optional<LevelBlueprint> try_level_blueprint_from_file(const char* filename) {
+  FILE* file = std::fopen(filename, "r");
+  if (!file) {
+    TraceLog(LOG_WARNING, "Cannot open map file: %s", filename);
+    return std::nullopt;
+  }
+
+  std::optional<LevelBlueprint> blueprint{level_blueprint_from_open_file(file)};
+  std::fclose(file);
+
+  if (!blueprint.has_value()) TraceLog(LOG_WARNING, "Invalid map file: %s", filename);
+  return blueprint;
+}
+
+LevelBlueprint level_blueprint_from_file(const char* filename) {
+  std::optional<LevelBlueprint> blueprint{try_level_blueprint_from_file(filename)};
+  if (!blueprint.has_value()) BAILF("Cannot load map file: %s", filename);
+  return std::move(*blueprint);
+}
+
+struct LevelTileChange {
+  IntVec2 pos{};
+  // Empty when the tile was added.
+  std::optional<TileSelection> before{};
+  // Empty when the tile was removed.
+  std::optional<TileSelection> after{};
+};
+
+/**
+ * Tiles that differ between two blueprints, keyed by position.
+ */
+std::vector<LevelTileChange> level_blueprint_tile_changes(LevelBlueprint const& before, LevelBlueprint const& after) {
+  std::unordered_map<IntVec2, TileSelection> before_tiles{};
+  before_tiles.reserve(before.tiles.size());
+  for (auto const& tile : before.tiles) before_tiles[tile.pos] = tile.selection;
+
+  std::vector<LevelTileChange> changes{};
+  for (auto const& tile : after.tiles) {
+    auto it = before_tiles.find(tile.pos);
+    if (it == before_tiles.end()) {
+      changes.push_back(LevelTileChange{tile.pos, std::nullopt, tile.selection});
+      continue;
+    }
+
+    if (!(it->second == tile.selection)) changes.push_back(LevelTileChange{tile.pos, it->second, tile.selection});
+    before_tiles.erase(it);
+  }
+
+  for (auto const& [pos, selection] : before_tiles) changes.push_back(LevelTileChange{pos, selection, std::nullopt});
+
+  return changes;
+}
+
+/**
+ * Serializes `blueprint` in the map file format. Calls `on_progress(done_fraction)` every few thousand tiles.
+ */
+template <typename F>
+void level_blueprint_to_buffer(LevelBlueprint const& blueprint, std::vector<char>* buffer, F&& on_progress) {
+  constexpr size_t const progress_step{4096};
+  // Header, tiles (7 ints each), groups.
+  buffer->clear();
+  buffer->reserve(sizeof(int) * (6 + blueprint.tiles.size() * 7));
+
+  buffer_write(buffer, blueprint.tile_width);
+  buffer_write(buffer, blueprint.tile_height);
+  buffer_write(buffer, blueprint.background_index);
+  buffer_write(buffer, static_cast<int>(blueprint.tiles.size()));
+  buffer_write(buffer, blueprint.character_position);
+
+  for (size_t i = 0; i < blueprint.tiles.size(); i++) {
+    LevelTile const& tile = blueprint.tiles[i];
+    buffer_write(buffer, tile.pos);
+    buffer_write(buffer, static_cast<int>(tile.selection.source));
+    buffer_write(buffer, tile.selection.tile_coord);
+
+    if (i % progress_step == 0) on_progress(static_cast<float>(i) / blueprint.tiles.size());
+  }
+
+  buffer_write(buffer, static_cast<int>(blueprint.interactive_groups.size()));
+  for (auto const& group : blueprint.interactive_groups) group.write(buffer);
+
+  on_progress(1.f);
+}
+
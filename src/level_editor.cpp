@@ -20,6 +20,9 @@
  */
 
 int main() {
+  logger.capture_trace_log();
+  logger.start();
+
   SetConfigFlags(FLAG_WINDOW_RESIZABLE);
 
   InitWindow(1800, 1200, "Pupu Level Editor");
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "asset_manager.h"
+#include "common.h"
+#include "level.h"
+#include "sprite_sheet.h"
+
+void append_prototype_textures(AnimationPrototype prototype, std::vector<int>* names) {
+  for (auto const& sheet : animation_prototype_sheets(prototype)) names->push_back(sheet.texture);
+}
+
+/**
+ * Textures the game needs for the tiles of `tile_source`. The editor-only `*__Example` sheets are never included.
+ */
+void append_tile_source_textures(TileSource tile_source, std::vector<int>* names) {
+  TileKind const& kind = tile_kind(tile_source);
+  for (int texture : kind.game_textures) {
+    if (texture != TEXTURE_NONE) names->push_back(texture);
+  }
+  for (int i = 0; i < kind.animation_count; i++) append_prototype_textures(kind.animations[i], names);
+}
+
+/**
+ * Sorted, unique set of textures needed to play `blueprint`: the character, the background and the tile sources used.
+ */
+std::vector<int> level_texture_names(LevelBlueprint const& blueprint) {
+  std::vector<int> names{TextureNames::Character__Appear, TextureNames::Character__Disappear};
+  append_prototype_textures(AnimationPrototype::Character1, &names);
+
+  if (blueprint.background_index >= 0 && blueprint.background_index < BACKGROUND_COUNT) {
+    names.push_back(TextureNames::Background__0 + blueprint.background_index);
+  }
+
+  bool is_source_used[TILE_SOURCE_COUNT]{};
+  for (auto const& [_, tile_selection] : blueprint.tiles) {
+    int source = static_cast<int>(tile_selection.source);
+    if (source < 0 || source >= TILE_SOURCE_COUNT || is_source_used[source]) continue;
+
+    is_source_used[source] = true;
+    append_tile_source_textures(tile_selection.source, &names);
+  }
+
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  return names;
+}
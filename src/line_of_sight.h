@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "collision_bitboard.h"
+#include "common.h"
+
+/**
+ * Grid DDA from the center of cell `from` to the center of cell `to`. Calls `is_blocked(x, y, is_step_horizontal)` for
+ * every cell the segment enters, the two end cells excluded. Returns false at the first blocked cell.
+ */
+template <typename B>
+bool grid_raycast(IntVec2 const from, IntVec2 const to, B&& is_blocked) {
+  int const dx = to.x - from.x;
+  int const dy = to.y - from.y;
+  int const step_x = (dx > 0) - (dx < 0);
+  int const step_y = (dy > 0) - (dy < 0);
+
+  // Parametric distance (0..1 over the segment) to the next vertical and horizontal cell border.
+  float const delta_x = dx == 0 ? 2.f : 1.f / std::abs(dx);
+  float const delta_y = dy == 0 ? 2.f : 1.f / std::abs(dy);
+  float next_x = delta_x * 0.5f;
+  float next_y = delta_y * 0.5f;
+
+  int x = from.x;
+  int y = from.y;
+  while (true) {
+    bool is_step_horizontal = next_x <= next_y;
+    if (is_step_horizontal) {
+      x += step_x;
+      next_x += delta_x;
+    } else {
+      y += step_y;
+      next_y += delta_y;
+    }
+
+    if (x == to.x && y == to.y) return true;
+    if (is_blocked(x, y, is_step_horizontal)) return false;
+  }
+}
+
+/**
+ * Line of sight between tile cells over the static walls and boxes, memoized until `clear`. Enemies watching the same
+ * character from the same cell share one raycast.
+ */
+struct LineOfSight {
+ public:
+  /**
+   * Whether nothing in `walls` or `boxes` stands between the centers of the two cells. A wall cell blocks the rays
+   * stepping into it along an axis it collides on, so one-way platforms only block vertical sight. Boxes block all.
+   */
+  bool is_clear(CollisionBitboard const& walls, CollisionBitboard const& boxes, IntVec2 const from, IntVec2 const to) {
+    uint64_t key = cell_key(from) << 32 | cell_key(to);
+    auto memo_it = memo.find(key);
+    if (memo_it != memo.end()) return memo_it->second;
+
+    bool is_clear = grid_raycast(from, to, [&](int x, int y, bool is_step_horizontal) {
+      if (x < 0 || y < 0 || x >= walls.get_width() || y >= walls.get_height()) return true;
+      if (boxes.get(x, y) != COLLISION_TYPE_NOTHING) return true;
+
+      int const axis_directions =
+          is_step_horizontal ? COLLISION_TYPE_LEFT | COLLISION_TYPE_RIGHT : COLLISION_TYPE_TOP | COLLISION_TYPE_BOTTOM;
+      return (walls.get(x, y) & axis_directions) != 0;
+    });
+
+    memo[key] = is_clear;
+    return is_clear;
+  }
+
+  void clear() {
+    memo.clear();
+  }
+
+ private:
+  std::unordered_map<uint64_t, bool> memo{};
+
+  static uint64_t cell_key(IntVec2 const cell) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(cell.x)) << 16 | static_cast<uint16_t>(cell.y);
+  }
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "raylib.h"
+
+// Records below this level compile to nothing. Builds can override it, e.g. `-DLOGGER_COMPILE_LEVEL=LOG_INFO`.
+#ifndef LOGGER_COMPILE_LEVEL
+#define LOGGER_COMPILE_LEVEL LOG_DEBUG
+#endif
+
+// Power of two. When the ring is full new records are dropped and counted, a frame never waits for the output.
+constexpr size_t const LOGGER_RING_CAPACITY{1024};
+constexpr size_t const LOGGER_PAYLOAD_SIZE{240};
+// String arguments are copied, the caller's buffer may be gone by the time the record is formatted.
+constexpr size_t const LOGGER_STRING_SIZE{64};
+constexpr size_t const LOGGER_LINE_SIZE{512};
+
+struct LogString {
+  char data[LOGGER_STRING_SIZE];
+};
+
+template <typename T>
+T log_arg_store(T value) {
+  static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>, "Unsupported log argument");
+  return value;
+}
+
+LogString log_arg_store(char const* value) {
+  LogString out{};
+  std::strncpy(out.data, value ? value : "(null)", LOGGER_STRING_SIZE - 1);
+  return out;
+}
+
+LogString log_arg_store(char* value) {
+  return log_arg_store(static_cast<char const*>(value));
+}
+
+template <typename T>
+T const& log_arg_load(T const& value) {
+  return value;
+}
+
+char const* log_arg_load(LogString const& value) {
+  return value.data;
+}
+
+struct LogRecord {
+  int level;
+  char const* format;
+  // Writes the final text of the record into `out`, like `snprintf`.
+  int (*write)(LogRecord const& record, char* out, size_t size);
+  alignas(std::max_align_t) unsigned char payload[LOGGER_PAYLOAD_SIZE];
+};
+
+struct LogCell {
+  std::atomic<size_t> sequence;
+  LogRecord record;
+};
+
+char const* log_level_name(int level) {
+  switch (level) {
+    case LOG_TRACE:
+      return "TRACE";
+    case LOG_DEBUG:
+      return "DEBUG";
+    case LOG_INFO:
+      return "INFO";
+    case LOG_WARNING:
+      return "WARNING";
+    case LOG_ERROR:
+      return "ERROR";
+    case LOG_FATAL:
+      return "FATAL";
+    default:
+      return "LOG";
+  }
+}
+
+/**
+ * Logger off the frame path. Producers copy the format string pointer and the raw arguments into a bounded lock-free
+ * ring (multi-producer, single consumer); a background thread does the `printf` formatting and the output.
+ * `format` must be a string literal, it is read after the call returned.
+ */
+struct Logger {
+ public:
+  Logger() {
+    for (size_t i = 0; i < LOGGER_RING_CAPACITY; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  ~Logger() {
+    should_stop.store(true, std::memory_order_release);
+    if (worker.joinable()) worker.join();
+    drain();
+  }
+
+  Logger(Logger const&) = delete;
+  Logger& operator=(Logger const&) = delete;
+
+  /**
+   * Starts the output thread. Until then records queue up, they are written by `flush` or at exit.
+   */
+  void start() {
+    if (worker.joinable()) return;
+    worker = std::thread([this]() { run(); });
+  }
+
+  template <typename... Args>
+  void push(int level, char const* format, Args... args) {
+    using Payload = std::tuple<decltype(log_arg_store(args))...>;
+    static_assert(sizeof(Payload) <= LOGGER_PAYLOAD_SIZE, "Too many log arguments");
+    static_assert(std::is_trivially_destructible_v<Payload>);
+
+    size_t pos;
+    LogCell* cell = acquire(&pos);
+    if (!cell) return;
+
+    cell->record.level = level;
+    cell->record.format = format;
+    cell->record.write = [](LogRecord const& record, char* out, size_t size) {
+      Payload const& payload = *std::launder(reinterpret_cast<Payload const*>(record.payload));
+      return std::apply(
+          [&](auto const&... stored) { return std::snprintf(out, size, record.format, log_arg_load(stored)...); },
+          payload);
+    };
+    new (cell->record.payload) Payload{log_arg_store(args)...};
+
+    cell->sequence.store(pos + 1, std::memory_order_release);
+  }
+
+  /**
+   * Formats right away, for callers that only have a `va_list`. Output still happens on the background thread.
+   */
+  void push_va_list(int level, char const* format, va_list args) {
+    size_t pos;
+    LogCell* cell = acquire(&pos);
+    if (!cell) return;
+
+    cell->record.level = level;
+    cell->record.format = nullptr;
+    cell->record.write = [](LogRecord const& record, char* out, size_t size) {
+      return std::snprintf(out, size, "%s", reinterpret_cast<char const*>(record.payload));
+    };
+    std::vsnprintf(reinterpret_cast<char*>(cell->record.payload), LOGGER_PAYLOAD_SIZE, format, args);
+
+    cell->sequence.store(pos + 1, std::memory_order_release);
+  }
+
+  /**
+   * Waits until everything pushed so far is written. Used before exiting on a fatal error.
+   */
+  void flush() {
+    if (!worker.joinable()) {
+      drain();
+      return;
+    }
+
+    size_t const target = enqueue_pos.load(std::memory_order_acquire);
+    for (int i = 0; i < 1000 && written.load(std::memory_order_acquire) < target; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  /**
+   * Sends raylib's `TraceLog` through the logger. Levels below `LOGGER_COMPILE_LEVEL` are filtered by raylib before
+   * formatting.
+   */
+  void capture_trace_log() {
+    SetTraceLogLevel(LOGGER_COMPILE_LEVEL);
+    SetTraceLogCallback(&Logger::trace_log_callback);
+  }
+
+ private:
+  LogCell cells[LOGGER_RING_CAPACITY];
+  alignas(64) std::atomic<size_t> enqueue_pos{0};
+  // Owned by the consumer.
+  alignas(64) size_t dequeue_pos{0};
+  std::atomic<size_t> written{0};
+  std::atomic<size_t> dropped{0};
+  std::atomic<bool> should_stop{false};
+  std::thread worker{};
+
+  static void trace_log_callback(int level, char const* text, va_list args);
+
+  LogCell* acquire(size_t* pos) {
+    size_t p = enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+      LogCell& cell = cells[p & (LOGGER_RING_CAPACITY - 1)];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(p);
+
+      if (diff == 0) {
+        if (enqueue_pos.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+          *pos = p;
+          return &cell;
+        }
+      } else if (diff < 0) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+      } else {
+        p = enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Writes every published record. Returns how many.
+   */
+  size_t drain() {
+    char line[LOGGER_LINE_SIZE];
+    size_t count{0};
+
+    while (true) {
+      LogCell& cell = cells[dequeue_pos & (LOGGER_RING_CAPACITY - 1)];
+      if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos + 1) break;
+
+      cell.record.write(cell.record, line, sizeof(line));
+      std::printf("%s: %s\n", log_level_name(cell.record.level), line);
+
+      cell.sequence.store(dequeue_pos + LOGGER_RING_CAPACITY, std::memory_order_release);
+      dequeue_pos++;
+      count++;
+    }
+
+    size_t const dropped_count = dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped_count > 0) std::printf("WARNING: Log ring full, dropped %zu records\n", dropped_count);
+
+    if (count > 0) {
+      std::fflush(stdout);
+      written.store(dequeue_pos, std::memory_order_release);
+    }
+    return count;
+  }
+
+  void run() {
+    while (!should_stop.load(std::memory_order_acquire)) {
+      if (drain() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+};
+
+static Logger logger{};
+
+void Logger::trace_log_callback(int level, char const* text, va_list args) {
+  logger.push_va_list(level, text, args);
+}
+
+/**
+ * Queues a `printf` style record. Below `LOGGER_COMPILE_LEVEL` the arguments are not even evaluated.
+ */
+#define LOGF(level, ...)                                             \
+  do {                                                               \
+    if constexpr ((level) >= LOGGER_COMPILE_LEVEL) {                 \
+      if (false) std::printf(__VA_ARGS__); /* Format checks only. */ \
+      logger.push((level), __VA_ARGS__);                             \
+    }                                                                \
+  } while (0)
@@ -1,21 +1,28 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <memory>
+#include <span>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "activity.h"
+#include "arena.h"
 #include "background.h"
+#include "collision_bitboard.h"
 #include "common.h"
 #include "interactive_object.h"
+#include "level.h"
+#include "line_of_sight.h"
+#include "moving_platform.h"
+#include "nav_graph.h"
 #include "raylib.h"
 
-struct HitMap {
-  int north{-1};
-  int south{-1};
-  int east{-1};
-  int west{-1};
-};
+// Contacts `Map::slide` follows before it gives up on the rest of the motion.
+constexpr int const MAP_MAX_SLIDE_SWEEPS{3};
 
 constexpr Vector2 const move_map[4] = {
     {0, 1.f},
@@ -24,47 +31,337 @@ constexpr Vector2 const move_map[4] = {
     {-1.f, 0},
 };
 
-constexpr HitMap NULL_HIT_MAP{};
-constexpr float const WALL_CHECK_THRESHOLD{3.f};
+struct SweepHit {
+  // Fraction of the motion travelled before the contact, 1 if nothing was hit.
+  float time{1.f};
+  // Points away from the blocking surface.
+  IntVec2 normal{};
+  // Absolute coordinate of the blocking surface on the normal's axis.
+  float surface{};
+};
+
+/**
+ * Nearest blocking coordinates around a rectangle, as returned by the `*_wall_of_range` queries.
+ */
+struct WallBounds {
+  int north;
+  int south;
+  int west;
+  int east;
+};
+
+/**
+ * A box of the map with its scaled hitbox, as stored in the box column and row index.
+ */
+struct BoxEntry {
+  IntVec2 pos;
+  Rectangle hitbox;
+};
+
+/**
+ * Ids of moving or removable map objects by the tile columns and rows their bounds cover, clamped to the map like the
+ * box index. `place` only re-files an object when the cells its bounds cover change.
+ */
+struct CellSpanIndex {
+ public:
+  void reset(int const new_cell_size, int const column_count, int const row_count) {
+    cell_size = new_cell_size;
+    columns.assign(column_count, {});
+    rows.assign(row_count, {});
+    spans.clear();
+  }
+
+  void place(int const id, Rectangle const& bounds) {
+    if (id >= static_cast<int>(spans.size())) spans.resize(id + 1);
+
+    CellSpan const span{column_span(bounds), row_span(bounds)};
+    if (span == spans[id]) return;
+
+    file(id, spans[id], false);
+    spans[id] = span;
+    file(id, span, true);
+  }
+
+  /**
+   * Calls `f(id)` once for every object covering any column of `rect`.
+   */
+  template <typename F>
+  void for_each_in_columns(Rectangle const& rect, F&& f) const {
+    auto [min, max] = column_span(rect);
+    for (int x = min; x <= max; x++) {
+      for (int id : columns[x]) {
+        // Visited in the first column of `rect` it covers.
+        if (std::max(spans[id].columns.first, min) == x) f(id);
+      }
+    }
+  }
+
+  /**
+   * Calls `f(id)` once for every object covering any row of `rect`.
+   */
+  template <typename F>
+  void for_each_in_rows(Rectangle const& rect, F&& f) const {
+    auto [min, max] = row_span(rect);
+    for (int y = min; y <= max; y++) {
+      for (int id : rows[y]) {
+        if (std::max(spans[id].rows.first, min) == y) f(id);
+      }
+    }
+  }
+
+ private:
+  struct CellSpan {
+    std::pair<int, int> columns{0, -1};
+    std::pair<int, int> rows{0, -1};
+
+    bool operator==(CellSpan const& other) const {
+      return columns == other.columns && rows == other.rows;
+    }
+  };
+
+  int cell_size{1};
+  std::vector<std::vector<int>> columns{};
+  std::vector<std::vector<int>> rows{};
+  std::vector<CellSpan> spans{};
+
+  std::pair<int, int> column_span(Rectangle const& rect) const {
+    return cell_span(leftx(rect), rightx(rect), static_cast<int>(columns.size()));
+  }
+
+  std::pair<int, int> row_span(Rectangle const& rect) const {
+    return cell_span(topy(rect), bottomy(rect), static_cast<int>(rows.size()));
+  }
+
+  std::pair<int, int> cell_span(float const from, float const to, int const count) const {
+    if (count <= 0) return {0, -1};
+
+    int min = std::clamp(static_cast<int>(floorf(from / cell_size)), 0, count - 1);
+    int max = std::clamp(static_cast<int>(floorf(to / cell_size)), 0, count - 1);
+    return {min, max};
+  }
+
+  void file(int const id, CellSpan const& span, bool const is_adding) {
+    for (int x = span.columns.first; x <= span.columns.second; x++) edit_bucket(&columns[x], id, is_adding);
+    for (int y = span.rows.first; y <= span.rows.second; y++) edit_bucket(&rows[y], id, is_adding);
+  }
+
+  static void edit_bucket(std::vector<int>* bucket, int const id, bool const is_adding) {
+    if (is_adding) {
+      bucket->push_back(id);
+    } else {
+      std::erase(*bucket, id);
+    }
+  }
+};
 
 struct Map {
  public:
-  Map(int const pixel_size) : pixel_size(pixel_size) {
+  Map(int const pixel_size) : pixel_size(pixel_size), interactive_activity(pixel_size) {
   }
 
-  void reload_world(int background_index, int new_tile_width, int new_tile_height,
-                    std::unordered_map<IntVec2, TileSelection>&& tiles) {
+  void reload_world(LevelBlueprint const& blueprint) {
     reset();
 
-    tile_width = new_tile_width;
-    tile_height = new_tile_height;
-    background.preload(background_index, new_tile_width, new_tile_height, pixel_size);
+    tile_width = blueprint.tile_width;
+    tile_height = blueprint.tile_height;
+    background.preload(blueprint.background_index, tile_width, tile_height, pixel_size);
 
-    for (auto&& [tile_pos, tile_selection] : tiles) {
-      switch (tile_selection.source) {
-        case TileSource::Gui:
-        case TileSource::Tileset:
+    std::unordered_map<IntVec2, TileSelection> platform_tiles{};
+    for (auto const& group : blueprint.interactive_groups) {
+      for (auto const& elem_pos : group.get_elems()) platform_tiles[elem_pos] = TileSelection{};
+    }
+
+    for (auto const& [tile_pos, tile_selection] : blueprint.tiles) {
+      if (platform_tiles.contains(tile_pos)) {
+        platform_tiles[tile_pos] = tile_selection;
+        continue;
+      }
+
+      switch (tile_kind(tile_selection.source).tile_class) {
+        case TileClass::Wall:
           walls[tile_pos] = tile_selection;
           break;
-        case TileSource::Box1:
-        case TileSource::Box2:
-        case TileSource::Box3:
+        case TileClass::Box:
           boxes[tile_pos] = tile_selection;
           break;
-        case TileSource::Trap5:
-          interactive_objects.push_back(
-              std::make_shared<DisappearingPlank>(pixel_size, tile_pos.scale(pixel_size).to_vector2()));
+        case TileClass::InteractiveObject:
+          add_disappearing_plank(tile_pos);
           break;
         default:
-          BAIL;
+          // Npcs and traps are owned by the app.
+          break;
+      }
+    }
+
+    for (auto const& group : blueprint.interactive_groups) {
+      std::vector<MovingPlatformElem> elems{};
+      for (auto const& elem_pos : group.get_elems()) {
+        TileSelection const& tile_selection = platform_tiles[elem_pos];
+        switch (tile_kind(tile_selection.source).tile_class) {
+          case TileClass::Wall:
+          case TileClass::Box:
+            elems.push_back(MovingPlatformElem{elem_pos, tile_selection});
+            break;
+          default:
+            TraceLog(LOG_WARNING, "Group element is not a wall or box");
+            break;
+        }
       }
+
+      if (!elems.empty()) moving_platforms.emplace_back(pixel_size, std::move(elems), group.get_behaviours());
     }
 
     recalculate();
   }
 
+  /**
+   * Puts every runtime object back to its initial state. Static collision data and the background are kept.
+   */
+  void restore() {
+    for (auto& interactive_object : interactive_objects) interactive_object->reset();
+    for (auto& moving_platform : moving_platforms) moving_platform.reset();
+    index_platforms();
+    is_activity_dirty = true;
+  }
+
+  /**
+   * Places a wall tile at runtime. Only the affected row and column of the hit map are rebuilt.
+   */
+  void set_wall(IntVec2 const tile_coord, TileSelection const& tile_selection) {
+    if (!is_tile_coord_valid(tile_coord.x, tile_coord.y)) {
+      TraceLog(LOG_WARNING, "Wall outside of the map: %d:%d", tile_coord.x, tile_coord.y);
+      return;
+    }
+
+    IntVec2 coord{tile_coord.scale(TILE_SIZE)};
+    walls[coord] = tile_selection;
+    update_wall_cell(tile_coord.x, tile_coord.y, tile_selection.collision_directions());
+  }
+
+  void remove_wall(IntVec2 const tile_coord) {
+    if (walls.erase(tile_coord.scale(TILE_SIZE)) == 0) return;
+    update_wall_cell(tile_coord.x, tile_coord.y, COLLISION_TYPE_NOTHING);
+  }
+
+  void set_box(IntVec2 const pos, TileSelection const& tile_selection) {
+    remove_box(pos);
+    boxes[pos] = tile_selection;
+    index_box(pos, tile_selection);
+    update_box_cells(tile_selection.hitbox(pos));
+  }
+
+  void remove_box(IntVec2 const pos) {
+    auto box_it = boxes.find(pos);
+    if (box_it == boxes.end()) return;
+
+    Rectangle const box_hitbox{box_it->second.hitbox(pos)};
+    unindex_box(pos, box_it->second);
+    boxes.erase(box_it);
+    update_box_cells(box_hitbox);
+  }
+
+  void add_disappearing_plank(IntVec2 const pos) {
+    interactive_objects.push_back(object_arena.make<DisappearingPlank>(pixel_size, pos.scale(pixel_size).to_vector2()));
+    object_index.place(static_cast<int>(interactive_objects.size()) - 1, interactive_objects.back()->bounds());
+    is_activity_dirty = true;
+  }
+
+  void remove_interactive_object(IntVec2 const pos) {
+    Vector2 const position{pos.scale(pixel_size).to_vector2()};
+    std::erase_if(interactive_objects, [&](InteractiveObject* interactive_object) {
+      Vector2 const object_position{interactive_object->position()};
+      if (object_position.x != position.x || object_position.y != position.y) return false;
+
+      object_arena.destroy(interactive_object);
+      return true;
+    });
+    // Ids shifted.
+    index_objects();
+    is_activity_dirty = true;
+  }
+
   void update(Rectangle const& character_hitbox) {
-    for (auto& interactive_object : interactive_objects) interactive_object->update(character_hitbox);
+    // Everything may have moved since the last tick.
+    line_of_sight.clear();
+
+    auto interactive_hitbox_of = [&](size_t i) { return interactive_objects[i]->hitbox(); };
+    if (is_activity_dirty) {
+      interactive_activity.reset(interactive_objects.size(), interactive_hitbox_of);
+      is_activity_dirty = false;
+    }
+
+    for (size_t i = 0; i < moving_platforms.size(); i++) {
+      moving_platforms[i].update();
+      platform_index.place(static_cast<int>(i), moving_platforms[i].bounds());
+    }
+    interactive_activity.update(screen_view(), interactive_hitbox_of,
+                                [&](size_t i) { interactive_objects[i]->update(character_hitbox); });
+  }
+
+  /**
+   * Horizontal direction (-1, 0 or 1) `agent_hitbox` should walk to chase `target_hitbox` over the static walls. 0 when
+   * they share a column, the target is unreachable, or the agent stands at the takeoff of its next fall or jump.
+   */
+  int nav_direction(Rectangle const& agent_hitbox, Rectangle const& target_hitbox) const {
+    int const cell = TILE_SIZE * pixel_size;
+    int agent_x = static_cast<int>(agent_hitbox.x + agent_hitbox.width / 2.f) / cell;
+    int target_x = static_cast<int>(target_hitbox.x + target_hitbox.width / 2.f) / cell;
+
+    int from = nav_graph.segment_below(collision_bitboard, agent_x, bottomy(agent_hitbox) / cell);
+    int to = nav_graph.segment_below(collision_bitboard, target_x, bottomy(target_hitbox) / cell);
+    return nav_graph.direction(from, agent_x, to, target_x);
+  }
+
+  /**
+   * Whether the static walls and boxes leave a clear line between the centers of the two hitboxes. Rays are cast
+   * between the tile cells of the centers and memoized for the current tick.
+   */
+  bool has_line_of_sight(Rectangle const& from_hitbox, Rectangle const& to_hitbox) const {
+    IntVec2 from{center_cell(from_hitbox)};
+    IntVec2 to{center_cell(to_hitbox)};
+    if (!is_tile_coord_valid(from.x, from.y) || !is_tile_coord_valid(to.x, to.y)) return false;
+    return line_of_sight.is_clear(collision_bitboard, box_bitboard, from, to);
+  }
+
+  /**
+   * How far the moving platforms carry or push `body_hitbox` after their last update. The move is swept through the map
+   * like any other, so walls and boxes stop it.
+   */
+  Vector2 platform_carry(Rectangle const& body_hitbox) const {
+    Vector2 push{vector_zero};
+    // Grown by a cell, a platform that carries or pushes the body touches it or moved out from under it.
+    float const cell = static_cast<float>(TILE_SIZE * pixel_size);
+    Rectangle const search{body_hitbox.x - cell, body_hitbox.y - cell, body_hitbox.width + 2.f * cell,
+                           body_hitbox.height + 2.f * cell};
+    platform_index.for_each_in_columns(search, [&](int id) {
+      if (push.x != 0.f || push.y != 0.f) return;
+      push = moving_platforms[id].push_delta(body_hitbox);
+    });
+    if (push.x == 0.f && push.y == 0.f) return vector_zero;
+
+    return slide(body_hitbox, push);
+  }
+
+  /**
+   * How far `rect` gets along `motion`, sliding along every surface hit on the way. One sweep per contact.
+   */
+  Vector2 slide(Rectangle rect, Vector2 motion) const {
+    Vector2 moved{vector_zero};
+    for (int i = 0; i < MAP_MAX_SLIDE_SWEEPS && (motion.x != 0.f || motion.y != 0.f); i++) {
+      SweepHit const hit = sweep(rect, motion);
+      Vector2 const step{Vector2Scale(motion, hit.time)};
+      rect = move(rect, step);
+      moved = Vector2Add(moved, step);
+      if (hit.time >= 1.f) break;
+
+      motion = Vector2Scale(motion, 1.f - hit.time);
+      if (hit.normal.x != 0) {
+        motion.x = 0.f;
+      } else {
+        motion.y = 0.f;
+      }
+    }
+    return moved;
   }
 
   void draw() const {
@@ -72,6 +369,7 @@ struct Map {
 
     for (auto const& [k, v] : walls) v.draw(k.scale(pixel_size).to_vector2(), pixel_size);
     for (auto const& [k, v] : boxes) v.draw(k.scale(pixel_size).to_vector2(), pixel_size);
+    for (auto const& moving_platform : moving_platforms) moving_platform.draw();
     for (auto const& interactive_object : interactive_objects) interactive_object->draw();
   }
 
@@ -79,6 +377,14 @@ struct Map {
     background.unload();
   }
 
+  /**
+   * Re-renders the background from its texture, after that was reloaded.
+   */
+  void rebake_background() {
+    int index = background.get_current_index();
+    if (index != -1) background.preload(index, tile_width, tile_height, pixel_size);
+  }
+
   int north_wall_of_range(Rectangle const& rect) const {
     int minx = leftx(rect) / (TILE_SIZE * pixel_size);
     int maxx = rightx(rect) / (TILE_SIZE * pixel_size);
@@ -87,19 +393,26 @@ struct Map {
     int max_y_coord = 0;
     for (int x = minx; x <= maxx; x++) {
       if (!is_tile_coord_valid(x, y)) continue;
-      max_y_coord = std::max(max_y_coord, hit_map[y * tile_width + x].north);
+      max_y_coord = std::max(max_y_coord, collision_bitboard.bottom_wall_above(x, y) + 1);
     }
 
     int out = max_y_coord * TILE_SIZE * pixel_size;
 
-    for (auto const& [pos, selection] : boxes) {
-      check_north_collision(&out, upscale(selection.hitbox(pos), pixel_size), rect);
-    }
+    for_each_box_in_columns(rect, [&](BoxEntry const& box) { check_north_collision(&out, box.hitbox, rect); });
 
-    for (auto const& interactive_object : interactive_objects) {
-      if ((interactive_object->collision_directions() & COLLISION_TYPE_BOTTOM) == 0) continue;
+    platform_index.for_each_in_columns(rect, [&](int id) {
+      MovingPlatform const& moving_platform = moving_platforms[id];
+      for (auto const& elem : moving_platform.get_elems()) {
+        if (!moving_platform.elem_collide_from(elem, COLLISION_TYPE_BOTTOM)) continue;
+        check_north_collision(&out, moving_platform.elem_hitbox(elem), rect);
+      }
+    });
+
+    object_index.for_each_in_columns(rect, [&](int id) {
+      InteractiveObject const* interactive_object = interactive_objects[id];
+      if ((interactive_object->collision_directions() & COLLISION_TYPE_BOTTOM) == 0) return;
       check_north_collision(&out, interactive_object->hitbox(), rect);
-    }
+    });
 
     return out;
   }
@@ -112,19 +425,26 @@ struct Map {
     int min_y_coord = tile_height;
     for (int x = minx; x <= maxx; x++) {
       if (!is_tile_coord_valid(x, y)) continue;
-      min_y_coord = std::min(min_y_coord, hit_map[y * tile_width + x].south);
+      min_y_coord = std::min(min_y_coord, collision_bitboard.top_wall_below(x, y));
     }
 
     int out = min_y_coord * TILE_SIZE * pixel_size - 1;
 
-    for (auto const& [pos, selection] : boxes) {
-      check_south_collision(&out, upscale(selection.hitbox(pos), pixel_size), rect);
-    }
+    for_each_box_in_columns(rect, [&](BoxEntry const& box) { check_south_collision(&out, box.hitbox, rect); });
 
-    for (auto const& interactive_object : interactive_objects) {
-      if ((interactive_object->collision_directions() & COLLISION_TYPE_TOP) == 0) continue;
+    platform_index.for_each_in_columns(rect, [&](int id) {
+      MovingPlatform const& moving_platform = moving_platforms[id];
+      for (auto const& elem : moving_platform.get_elems()) {
+        if (!moving_platform.elem_collide_from(elem, COLLISION_TYPE_TOP)) continue;
+        check_south_collision(&out, moving_platform.elem_hitbox(elem), rect);
+      }
+    });
+
+    object_index.for_each_in_columns(rect, [&](int id) {
+      InteractiveObject const* interactive_object = interactive_objects[id];
+      if ((interactive_object->collision_directions() & COLLISION_TYPE_TOP) == 0) return;
       check_south_collision(&out, interactive_object->hitbox(), rect);
-    }
+    });
 
     return out;
   }
@@ -137,19 +457,26 @@ struct Map {
     int max_x_coord = 0;
     for (int y = miny; y <= maxy; y++) {
       if (!is_tile_coord_valid(x, y)) continue;
-      max_x_coord = std::max(max_x_coord, hit_map[y * tile_width + x].west);
+      max_x_coord = std::max(max_x_coord, collision_bitboard.left_wall_before(x, y) + 1);
     }
 
     int out = max_x_coord * TILE_SIZE * pixel_size;
 
-    for (auto const& [pos, selection] : boxes) {
-      check_west_collision(&out, upscale(selection.hitbox(pos), pixel_size), rect);
-    }
+    for_each_box_in_rows(rect, [&](BoxEntry const& box) { check_west_collision(&out, box.hitbox, rect); });
+
+    platform_index.for_each_in_rows(rect, [&](int id) {
+      MovingPlatform const& moving_platform = moving_platforms[id];
+      for (auto const& elem : moving_platform.get_elems()) {
+        if (!moving_platform.elem_collide_from(elem, COLLISION_TYPE_LEFT)) continue;
+        check_west_collision(&out, moving_platform.elem_hitbox(elem), rect);
+      }
+    });
 
-    for (auto const& interactive_object : interactive_objects) {
-      if ((interactive_object->collision_directions() & COLLISION_TYPE_RIGHT) == 0) continue;
+    object_index.for_each_in_rows(rect, [&](int id) {
+      InteractiveObject const* interactive_object = interactive_objects[id];
+      if ((interactive_object->collision_directions() & COLLISION_TYPE_RIGHT) == 0) return;
       check_west_collision(&out, interactive_object->hitbox(), rect);
-    }
+    });
 
     return out;
   }
@@ -162,73 +489,317 @@ struct Map {
     int min_x_coord = tile_width;
     for (int y = miny; y <= maxy; y++) {
       if (!is_tile_coord_valid(x, y)) continue;
-      min_x_coord = std::min(min_x_coord, hit_map[y * tile_width + x].east);
+      min_x_coord = std::min(min_x_coord, collision_bitboard.right_wall_after(x, y));
     }
 
     int out = min_x_coord * TILE_SIZE * pixel_size - 1;
 
-    for (auto const& [pos, selection] : boxes) {
-      check_east_collision(&out, upscale(selection.hitbox(pos), pixel_size), rect);
-    }
+    for_each_box_in_rows(rect, [&](BoxEntry const& box) { check_east_collision(&out, box.hitbox, rect); });
+
+    platform_index.for_each_in_rows(rect, [&](int id) {
+      MovingPlatform const& moving_platform = moving_platforms[id];
+      for (auto const& elem : moving_platform.get_elems()) {
+        if (!moving_platform.elem_collide_from(elem, COLLISION_TYPE_RIGHT)) continue;
+        check_east_collision(&out, moving_platform.elem_hitbox(elem), rect);
+      }
+    });
 
-    for (auto const& interactive_object : interactive_objects) {
-      if ((interactive_object->collision_directions() & COLLISION_TYPE_LEFT) == 0) continue;
+    object_index.for_each_in_rows(rect, [&](int id) {
+      InteractiveObject const* interactive_object = interactive_objects[id];
+      if ((interactive_object->collision_directions() & COLLISION_TYPE_LEFT) == 0) return;
       check_east_collision(&out, interactive_object->hitbox(), rect);
-    }
+    });
 
     return out;
   }
 
+  /**
+   * All four `*_wall_of_range` queries for every rectangle of `rects`, written to `out` (same size) in the same order.
+   */
+  void walls_of_ranges(std::span<Rectangle const> rects, std::span<WallBounds> out) const {
+    int const cell = TILE_SIZE * pixel_size;
+
+    for (size_t i = 0; i < rects.size(); i++) {
+      Rectangle const& rect = rects[i];
+      int minx = leftx(rect) / cell;
+      int maxx = rightx(rect) / cell;
+      int miny = topy(rect) / cell;
+      int maxy = bottomy(rect) / cell;
+
+      int max_y_coord = 0;
+      int min_y_coord = tile_height;
+      for (int x = minx; x <= maxx; x++) {
+        if (is_tile_coord_valid(x, miny)) {
+          max_y_coord = std::max(max_y_coord, collision_bitboard.bottom_wall_above(x, miny) + 1);
+        }
+        if (is_tile_coord_valid(x, maxy)) {
+          min_y_coord = std::min(min_y_coord, collision_bitboard.top_wall_below(x, maxy));
+        }
+      }
+
+      int max_x_coord = 0;
+      int min_x_coord = tile_width;
+      for (int y = miny; y <= maxy; y++) {
+        if (!is_tile_coord_valid(minx, y)) continue;
+        max_x_coord = std::max(max_x_coord, collision_bitboard.left_wall_before(minx, y) + 1);
+        min_x_coord = std::min(min_x_coord, collision_bitboard.right_wall_after(minx, y));
+      }
+
+      out[i] = WallBounds{max_y_coord * cell, min_y_coord * cell - 1, max_x_coord * cell, min_x_coord * cell - 1};
+
+      for_each_box_in_columns(rect, [&](BoxEntry const& box) {
+        check_all_collisions(&out[i], box.hitbox, COLLISION_TYPE_TOP | COLLISION_TYPE_BOTTOM, rect);
+      });
+      for_each_box_in_rows(rect, [&](BoxEntry const& box) {
+        check_all_collisions(&out[i], box.hitbox, COLLISION_TYPE_LEFT | COLLISION_TYPE_RIGHT, rect);
+      });
+
+      platform_index.for_each_in_columns(rect, [&](int id) {
+        check_platform_collisions(&out[i], moving_platforms[id], COLLISION_TYPE_TOP | COLLISION_TYPE_BOTTOM, rect);
+      });
+      platform_index.for_each_in_rows(rect, [&](int id) {
+        check_platform_collisions(&out[i], moving_platforms[id], COLLISION_TYPE_LEFT | COLLISION_TYPE_RIGHT, rect);
+      });
+
+      object_index.for_each_in_columns(rect, [&](int id) {
+        check_object_collisions(&out[i], *interactive_objects[id], COLLISION_TYPE_TOP | COLLISION_TYPE_BOTTOM, rect);
+      });
+      object_index.for_each_in_rows(rect, [&](int id) {
+        check_object_collisions(&out[i], *interactive_objects[id], COLLISION_TYPE_LEFT | COLLISION_TYPE_RIGHT, rect);
+      });
+    }
+  }
+
+  /**
+   * Sweeps `rect` along `motion` and returns the first contact with a wall, box, moving platform or interactive object.
+   * Tiles are visited with a grid traversal along the leading edges, so fast bodies cannot skip over thin walls.
+   */
+  SweepHit sweep(Rectangle const& rect, Vector2 const motion) const {
+    SweepHit hit{};
+
+    if (motion.x != 0.f) sweep_tiles_horizontal(rect, motion, &hit);
+    if (motion.y != 0.f) sweep_tiles_vertical(rect, motion, &hit);
+
+    // Grown by a pixel so objects just touching the swept area are found. A box spanning several swept columns is
+    // tested once per column, the earliest hit stays the same.
+    Rectangle const swept{sweep_bounds(rect, motion)};
+    Rectangle const search{swept.x - 1.f, swept.y - 1.f, swept.width + 2.f, swept.height + 2.f};
+    for_each_box_in_columns(search, [&](BoxEntry const& box) {
+      sweep_object(rect, motion, box.hitbox, COLLISION_TYPE_ALL, &hit);
+    });
+
+    platform_index.for_each_in_columns(search, [&](int id) {
+      MovingPlatform const& moving_platform = moving_platforms[id];
+      if (!CheckCollisionRecs(moving_platform.bounds(), swept)) return;
+      for (auto const& elem : moving_platform.get_elems()) {
+        int directions{COLLISION_TYPE_NOTHING};
+        if (moving_platform.elem_collide_from(elem, COLLISION_TYPE_TOP)) directions |= COLLISION_TYPE_TOP;
+        if (moving_platform.elem_collide_from(elem, COLLISION_TYPE_BOTTOM)) directions |= COLLISION_TYPE_BOTTOM;
+        // Tile semantics: a body moving left is stopped by LEFT, moving right by RIGHT.
+        if (moving_platform.elem_collide_from(elem, COLLISION_TYPE_LEFT)) directions |= COLLISION_TYPE_RIGHT;
+        if (moving_platform.elem_collide_from(elem, COLLISION_TYPE_RIGHT)) directions |= COLLISION_TYPE_LEFT;
+        sweep_object(rect, motion, moving_platform.elem_hitbox(elem), directions, &hit);
+      }
+    });
+
+    object_index.for_each_in_columns(search, [&](int id) {
+      InteractiveObject const* interactive_object = interactive_objects[id];
+      sweep_object(rect, motion, interactive_object->hitbox(), interactive_object->collision_directions(), &hit);
+    });
+
+    return hit;
+  }
+
  private:
   Background background{};
   int tile_width{};
   int tile_height{};
   std::unordered_map<IntVec2, TileSelection> walls{};
   std::unordered_map<IntVec2, TileSelection> boxes{};
-  std::vector<HitMap> hit_map{};
+  // Boxes by the tile columns and rows their hitbox covers, clamped to the map. The north and south queries only look
+  // at the columns of the rectangle, west and east at its rows.
+  std::vector<std::vector<BoxEntry>> box_columns{};
+  std::vector<std::vector<BoxEntry>> box_rows{};
+  // Collision directions of the wall in each tile cell.
+  CollisionBitboard collision_bitboard{};
+  // Built from `collision_bitboard`; boxes and moving objects are not part of it.
+  NavGraph nav_graph{};
+  // Tile cells covered by a box, all directions set.
+  CollisionBitboard box_bitboard{};
+  mutable LineOfSight line_of_sight{};
   int const pixel_size;
-  std::vector<std::shared_ptr<InteractiveObject>> interactive_objects{};
+  // Owns the interactive objects.
+  Arena object_arena{};
+  std::vector<InteractiveObject*> interactive_objects{};
+  // Moving platforms always update, riders depend on them.
+  ActivityScheduler interactive_activity;
+  bool is_activity_dirty{false};
+  std::vector<MovingPlatform> moving_platforms{};
+  // Moving platforms and interactive objects by their bounds, ids are indices into the vectors.
+  CellSpanIndex platform_index{};
+  CellSpanIndex object_index{};
 
   void reset() {
     walls.clear();
-    hit_map.clear();
+    boxes.clear();
+    box_columns.clear();
+    box_rows.clear();
+    interactive_objects.clear();
+    object_arena.reset();
+    moving_platforms.clear();
+    platform_index.reset(TILE_SIZE * pixel_size, 0, 0);
+    object_index.reset(TILE_SIZE * pixel_size, 0, 0);
+    collision_bitboard.clear();
+    box_bitboard.clear();
+    line_of_sight.clear();
+    is_activity_dirty = true;
   }
 
   void recalculate() {
-    hit_map.clear();
-    hit_map.resize(tile_width * tile_height, NULL_HIT_MAP);
-
-    for (int y = 0; y < tile_height; y++) {
-      int west_wall = 0;
-      int east_wall = tile_width;
-
-      for (int x = 0; x < tile_width; x++) {
-        hit_map[y * tile_width + x].west = west_wall;
-        IntVec2 coord{x * TILE_SIZE, y * TILE_SIZE};
-        if (walls.contains(coord) && walls[coord].collide_from(COLLISION_TYPE_LEFT)) west_wall = x + 1;
-
-        hit_map[y * tile_width + (tile_width - 1 - x)].east = east_wall;
-        IntVec2 coord_inv{(tile_width - 1 - x) * TILE_SIZE, y * TILE_SIZE};
-        if (walls.contains(coord_inv) && walls[coord_inv].collide_from(COLLISION_TYPE_RIGHT))
-          east_wall = (tile_width - 1 - x);
-      }
+    collision_bitboard.resize(tile_width, tile_height);
+
+    for (auto const& [coord, selection] : walls) {
+      int x = coord.x / TILE_SIZE;
+      int y = coord.y / TILE_SIZE;
+      if (!is_tile_coord_valid(x, y)) continue;
+      collision_bitboard.set(x, y, selection.collision_directions());
     }
 
-    for (int x = 0; x < tile_width; x++) {
-      int north_wall = 0;
-      int south_wall = tile_height;
+    box_columns.assign(tile_width, {});
+    box_rows.assign(tile_height, {});
+    for (auto const& [pos, selection] : boxes) index_box(pos, selection);
+    index_platforms();
+    index_objects();
 
-      for (int y = 0; y < tile_height; y++) {
-        hit_map[y * tile_width + x].north = north_wall;
-        IntVec2 coord{x * TILE_SIZE, y * TILE_SIZE};
-        if (walls.contains(coord) && walls[coord].collide_from(COLLISION_TYPE_BOTTOM)) north_wall = y + 1;
+    rebuild_nav_graph();
+    rebuild_box_bitboard();
+  }
 
-        hit_map[(tile_height - 1 - y) * tile_width + x].south = south_wall;
-        IntVec2 coord_inv{x * TILE_SIZE, (tile_height - 1 - y) * TILE_SIZE};
-        if (walls.contains(coord_inv) && walls[coord_inv].collide_from(COLLISION_TYPE_TOP))
-          south_wall = (tile_height - 1 - y);
+  void rebuild_nav_graph() {
+    nav_graph.build(collision_bitboard, NavJumpLimits::from_player_physics(TILE_SIZE * pixel_size));
+  }
+
+  void rebuild_box_bitboard() {
+    box_bitboard.resize(tile_width, tile_height);
+
+    for (auto const& [pos, selection] : boxes) {
+      auto [min, max] = box_cells(selection.hitbox(pos));
+      for (int y = min.y; y <= max.y; y++) {
+        for (int x = min.x; x <= max.x; x++) {
+          if (is_tile_coord_valid(x, y)) box_bitboard.set(x, y, COLLISION_TYPE_ALL);
+        }
+      }
+    }
+
+    line_of_sight.clear();
+  }
+
+  /**
+   * Sets the box bitboard cells under the unscaled `box_hitbox` again after a box edit, from the boxes indexed in
+   * their columns.
+   */
+  void update_box_cells(Rectangle const& box_hitbox) {
+    auto [min, max] = box_cells(box_hitbox);
+    for (int x = min.x; x <= max.x; x++) {
+      for (int y = min.y; y <= max.y; y++) {
+        if (!is_tile_coord_valid(x, y)) continue;
+
+        bool is_covered = std::any_of(box_columns[x].begin(), box_columns[x].end(), [&](BoxEntry const& box) {
+          auto [box_min, box_max] = box_cells(boxes.at(box.pos).hitbox(box.pos));
+          return box_min.x <= x && x <= box_max.x && box_min.y <= y && y <= box_max.y;
+        });
+        box_bitboard.set(x, y, is_covered ? COLLISION_TYPE_ALL : COLLISION_TYPE_NOTHING);
       }
     }
+
+    line_of_sight.clear();
+  }
+
+  /**
+   * First and last tile cell the unscaled `box_hitbox` covers in the box bitboard, not clamped to the map.
+   */
+  static std::pair<IntVec2, IntVec2> box_cells(Rectangle const& box_hitbox) {
+    IntVec2 min{static_cast<int>(leftx(box_hitbox)) / TILE_SIZE, static_cast<int>(topy(box_hitbox)) / TILE_SIZE};
+    IntVec2 max{static_cast<int>(rightx(box_hitbox)) / TILE_SIZE, static_cast<int>(bottomy(box_hitbox)) / TILE_SIZE};
+    return {min, max};
+  }
+
+  /**
+   * Inclusive range of the `count` cells that scaled map pixels `from`..`to` cover, clamped to the existing cells.
+   * Empty (min > max) without cells.
+   */
+  std::pair<int, int> cell_span(float const from, float const to, int const count) const {
+    if (count <= 0) return {0, -1};
+
+    float const cell = static_cast<float>(TILE_SIZE * pixel_size);
+    int min = std::clamp(static_cast<int>(floorf(from / cell)), 0, count - 1);
+    int max = std::clamp(static_cast<int>(floorf(to / cell)), 0, count - 1);
+    return {min, max};
+  }
+
+  template <typename F>
+  void for_each_box_in_columns(Rectangle const& rect, F&& f) const {
+    auto [minx, maxx] = cell_span(leftx(rect), rightx(rect), static_cast<int>(box_columns.size()));
+    for (int x = minx; x <= maxx; x++) {
+      for (BoxEntry const& box : box_columns[x]) f(box);
+    }
+  }
+
+  template <typename F>
+  void for_each_box_in_rows(Rectangle const& rect, F&& f) const {
+    auto [miny, maxy] = cell_span(topy(rect), bottomy(rect), static_cast<int>(box_rows.size()));
+    for (int y = miny; y <= maxy; y++) {
+      for (BoxEntry const& box : box_rows[y]) f(box);
+    }
+  }
+
+  void index_box(IntVec2 const pos, TileSelection const& selection) {
+    BoxEntry const entry{pos, upscale(selection.hitbox(pos), pixel_size)};
+
+    auto [minx, maxx] = cell_span(leftx(entry.hitbox), rightx(entry.hitbox), static_cast<int>(box_columns.size()));
+    for (int x = minx; x <= maxx; x++) box_columns[x].push_back(entry);
+
+    auto [miny, maxy] = cell_span(topy(entry.hitbox), bottomy(entry.hitbox), static_cast<int>(box_rows.size()));
+    for (int y = miny; y <= maxy; y++) box_rows[y].push_back(entry);
+  }
+
+  void unindex_box(IntVec2 const pos, TileSelection const& selection) {
+    Rectangle const hitbox{upscale(selection.hitbox(pos), pixel_size)};
+    auto is_this_box = [&](BoxEntry const& box) { return box.pos == pos; };
+
+    auto [minx, maxx] = cell_span(leftx(hitbox), rightx(hitbox), static_cast<int>(box_columns.size()));
+    for (int x = minx; x <= maxx; x++) std::erase_if(box_columns[x], is_this_box);
+
+    auto [miny, maxy] = cell_span(topy(hitbox), bottomy(hitbox), static_cast<int>(box_rows.size()));
+    for (int y = miny; y <= maxy; y++) std::erase_if(box_rows[y], is_this_box);
+  }
+
+  void index_platforms() {
+    platform_index.reset(TILE_SIZE * pixel_size, tile_width, tile_height);
+    for (size_t i = 0; i < moving_platforms.size(); i++) {
+      platform_index.place(static_cast<int>(i), moving_platforms[i].bounds());
+    }
+  }
+
+  void index_objects() {
+    object_index.reset(TILE_SIZE * pixel_size, tile_width, tile_height);
+    for (size_t i = 0; i < interactive_objects.size(); i++) {
+      object_index.place(static_cast<int>(i), interactive_objects[i]->bounds());
+    }
+  }
+
+  IntVec2 center_cell(Rectangle const& rect) const {
+    int const cell = TILE_SIZE * pixel_size;
+    return IntVec2{static_cast<int>(rect.x + rect.width / 2.f) / cell,
+                   static_cast<int>(rect.y + rect.height / 2.f) / cell};
+  }
+
+  void update_wall_cell(int x, int y, int directions) {
+    if (!is_tile_coord_valid(x, y)) return;
+    if (collision_bitboard.get(x, y) == directions) return;
+    collision_bitboard.set(x, y, directions);
+    line_of_sight.clear();
+    nav_graph.update_cell(collision_bitboard, x, y);
   }
 
   bool is_tile_coord_valid(int x, int y) const {
@@ -253,6 +824,40 @@ struct Map {
     }
   }
 
+  /**
+   * Applies the `check_*_collision` of each direction in `directions`: BOTTOM to north, TOP to south, LEFT to west and
+   * RIGHT to east, like the tile queries.
+   */
+  void check_all_collisions(WallBounds* out, Rectangle const& map_object_hitbox, int directions,
+                            Rectangle const& collidee_hitbox) const {
+    if (directions & COLLISION_TYPE_BOTTOM) check_north_collision(&out->north, map_object_hitbox, collidee_hitbox);
+    if (directions & COLLISION_TYPE_TOP) check_south_collision(&out->south, map_object_hitbox, collidee_hitbox);
+    if (directions & COLLISION_TYPE_LEFT) check_west_collision(&out->west, map_object_hitbox, collidee_hitbox);
+    if (directions & COLLISION_TYPE_RIGHT) check_east_collision(&out->east, map_object_hitbox, collidee_hitbox);
+  }
+
+  void check_platform_collisions(WallBounds* out, MovingPlatform const& moving_platform, int directions,
+                                 Rectangle const& collidee_hitbox) const {
+    for (auto const& elem : moving_platform.get_elems()) {
+      int elem_directions{COLLISION_TYPE_NOTHING};
+      if (moving_platform.elem_collide_from(elem, COLLISION_TYPE_BOTTOM)) elem_directions |= COLLISION_TYPE_BOTTOM;
+      if (moving_platform.elem_collide_from(elem, COLLISION_TYPE_TOP)) elem_directions |= COLLISION_TYPE_TOP;
+      if (moving_platform.elem_collide_from(elem, COLLISION_TYPE_LEFT)) elem_directions |= COLLISION_TYPE_LEFT;
+      if (moving_platform.elem_collide_from(elem, COLLISION_TYPE_RIGHT)) elem_directions |= COLLISION_TYPE_RIGHT;
+      check_all_collisions(out, moving_platform.elem_hitbox(elem), directions & elem_directions, collidee_hitbox);
+    }
+  }
+
+  void check_object_collisions(WallBounds* out, InteractiveObject const& interactive_object, int directions,
+                               Rectangle const& collidee_hitbox) const {
+    // Objects block the west query from the RIGHT and the east query from the LEFT, unlike the tiles.
+    int object_directions{interactive_object.collision_directions()};
+    int query_directions{object_directions & (COLLISION_TYPE_TOP | COLLISION_TYPE_BOTTOM)};
+    if (object_directions & COLLISION_TYPE_RIGHT) query_directions |= COLLISION_TYPE_LEFT;
+    if (object_directions & COLLISION_TYPE_LEFT) query_directions |= COLLISION_TYPE_RIGHT;
+    check_all_collisions(out, interactive_object.hitbox(), directions & query_directions, collidee_hitbox);
+  }
+
   void check_east_collision(int* out, Rectangle const& map_object_hitbox, Rectangle const& collidee_hitbox) const {
     if (is_vertical_overlap(map_object_hitbox, collidee_hitbox)) {
       if (leftx(map_object_hitbox) < *out &&
@@ -270,4 +875,137 @@ struct Map {
       }
     }
   }
+
+  float sweep_tolerance() const {
+    return WALL_CHECK_THRESHOLD * pixel_size;
+  }
+
+  bool is_sweep_blocking_tile(int x, int y, int direction) const {
+    if (x < 0 || y < 0 || x >= tile_width || y >= tile_height) return true;
+    return (collision_bitboard.get(x, y) & direction) != 0;
+  }
+
+  void sweep_tiles_horizontal(Rectangle const& rect, Vector2 const motion, SweepHit* hit) const {
+    float const cell = static_cast<float>(TILE_SIZE * pixel_size);
+    bool const is_east = motion.x > 0.f;
+    float const lead = is_east ? rect.x + rect.width : rect.x;
+    int const step = is_east ? 1 : -1;
+
+    // First column boundary in front of the leading edge, allowing a small overlap like the range queries do.
+    int boundary = is_east ? static_cast<int>(ceilf((lead - sweep_tolerance()) / cell))
+                           : static_cast<int>(floorf((lead + sweep_tolerance()) / cell));
+
+    for (;; boundary += step) {
+      float time = std::max(0.f, (boundary * cell - lead) / motion.x);
+      if (time >= hit->time) return;
+
+      int x = is_east ? boundary : boundary - 1;
+      float top = rect.y + motion.y * time;
+      int miny = static_cast<int>(floorf(top / cell));
+      int maxy = static_cast<int>(ceilf((top + rect.height) / cell)) - 1;
+
+      for (int y = std::max(miny, 0); y <= std::min(maxy, tile_height - 1); y++) {
+        if (is_sweep_blocking_tile(x, y, is_east ? COLLISION_TYPE_RIGHT : COLLISION_TYPE_LEFT)) {
+          *hit = SweepHit{time, IntVec2{-step, 0}, boundary * cell};
+          return;
+        }
+      }
+
+      if (x < 0 || x >= tile_width) return;
+    }
+  }
+
+  void sweep_tiles_vertical(Rectangle const& rect, Vector2 const motion, SweepHit* hit) const {
+    float const cell = static_cast<float>(TILE_SIZE * pixel_size);
+    bool const is_south = motion.y > 0.f;
+    float const lead = is_south ? rect.y + rect.height : rect.y;
+    int const step = is_south ? 1 : -1;
+
+    int boundary = is_south ? static_cast<int>(ceilf((lead - sweep_tolerance()) / cell))
+                            : static_cast<int>(floorf((lead + sweep_tolerance()) / cell));
+
+    for (;; boundary += step) {
+      float time = std::max(0.f, (boundary * cell - lead) / motion.y);
+      if (time >= hit->time) return;
+
+      int y = is_south ? boundary : boundary - 1;
+      float left = rect.x + motion.x * time;
+      int minx = static_cast<int>(floorf(left / cell));
+      int maxx = static_cast<int>(ceilf((left + rect.width) / cell)) - 1;
+
+      for (int x = std::max(minx, 0); x <= std::min(maxx, tile_width - 1); x++) {
+        if (is_sweep_blocking_tile(x, y, is_south ? COLLISION_TYPE_TOP : COLLISION_TYPE_BOTTOM)) {
+          *hit = SweepHit{time, IntVec2{0, -step}, boundary * cell};
+          return;
+        }
+      }
+
+      if (y < 0 || y >= tile_height) return;
+    }
+  }
+
+  /**
+   * Swept AABB test against a single object. `directions` is the set of sides the object can be hit on.
+   */
+  void sweep_object(Rectangle const& rect, Vector2 const motion, Rectangle const& object, int directions,
+                    SweepHit* hit) const {
+    float entry_x{-INFINITY};
+    float exit_x{INFINITY};
+    float entry_y{-INFINITY};
+    float exit_y{INFINITY};
+
+    if (motion.x > 0.f) {
+      entry_x = object.x - (rect.x + rect.width);
+      exit_x = object.x + object.width - rect.x;
+    } else if (motion.x < 0.f) {
+      entry_x = rect.x - (object.x + object.width);
+      exit_x = rect.x + rect.width - object.x;
+    } else if (rect.x >= object.x + object.width || rect.x + rect.width <= object.x) {
+      return;
+    }
+
+    if (motion.y > 0.f) {
+      entry_y = object.y - (rect.y + rect.height);
+      exit_y = object.y + object.height - rect.y;
+    } else if (motion.y < 0.f) {
+      entry_y = rect.y - (object.y + object.height);
+      exit_y = rect.y + rect.height - object.y;
+    } else if (rect.y >= object.y + object.height || rect.y + rect.height <= object.y) {
+      return;
+    }
+
+    float const time_entry_x = motion.x != 0.f ? entry_x / fabsf(motion.x) : -INFINITY;
+    float const time_exit_x = motion.x != 0.f ? exit_x / fabsf(motion.x) : INFINITY;
+    float const time_entry_y = motion.y != 0.f ? entry_y / fabsf(motion.y) : -INFINITY;
+    float const time_exit_y = motion.y != 0.f ? exit_y / fabsf(motion.y) : INFINITY;
+
+    bool const is_x_axis = time_entry_x > time_entry_y;
+    float const entry_distance = is_x_axis ? entry_x : entry_y;
+    float const time_entry = std::max(time_entry_x, time_entry_y);
+    float const time_exit = std::min(time_exit_x, time_exit_y);
+
+    if (time_entry > time_exit || time_exit <= 0.f) return;
+    if (entry_distance < -sweep_tolerance()) return;
+
+    float const time = std::max(0.f, time_entry);
+    if (time >= hit->time) return;
+
+    SweepHit candidate{};
+    if (is_x_axis) {
+      bool const is_east = motion.x > 0.f;
+      if ((directions & (is_east ? COLLISION_TYPE_LEFT : COLLISION_TYPE_RIGHT)) == 0) return;
+      candidate = SweepHit{time, IntVec2{is_east ? -1 : 1, 0}, is_east ? object.x : object.x + object.width};
+    } else {
+      bool const is_south = motion.y > 0.f;
+      if ((directions & (is_south ? COLLISION_TYPE_TOP : COLLISION_TYPE_BOTTOM)) == 0) return;
+      candidate = SweepHit{time, IntVec2{0, is_south ? -1 : 1}, is_south ? object.y : object.y + object.height};
+    }
+
+    *hit = candidate;
+  }
+
+  Rectangle sweep_bounds(Rectangle const& rect, Vector2 const motion) const {
+    return Rectangle{std::min(rect.x, rect.x + motion.x), std::min(rect.y, rect.y + motion.y),
+                     rect.width + fabsf(motion.x), rect.height + fabsf(motion.y)};
+  }
 };
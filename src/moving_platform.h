@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "common.h"
+#include "level.h"
+#include "raylib.h"
+
+constexpr float const MovingPlatformSpeed{60.f};
+
+struct MovingPlatformElem {
+  // Unscaled map position at spawn.
+  IntVec2 pos{};
+  TileSelection selection{};
+};
+
+struct MovingPlatformAxis {
+  bool is_active{false};
+  float min_offset{};
+  float max_offset{};
+  float direction{1.f};
+};
+
+/**
+ * Kinematic body made of the tiles of an editor interactive group. It is moved by its behaviours and never enters the
+ * static hit map; the map queries its elements directly.
+ */
+struct MovingPlatform {
+ public:
+  MovingPlatform(int const pixel_size, std::vector<MovingPlatformElem>&& new_elems,
+                 std::vector<ObjectBehaviour> const& behaviours)
+      : pixel_size(pixel_size), elems(std::move(new_elems)) {
+    IntVec2 origin{elems.front().pos};
+    for (auto const& elem : elems) {
+      origin.x = std::min(origin.x, elem.pos.x);
+      origin.y = std::min(origin.y, elem.pos.y);
+    }
+
+    for (auto const& behaviour : behaviours) {
+      if (behaviour.movement_range.x >= behaviour.movement_range.y) continue;
+
+      switch (behaviour.type) {
+        case ObjectBehaviourType::HorizontalMovement:
+          horizontal = MovingPlatformAxis{true, static_cast<float>(behaviour.movement_range.x - origin.x) * pixel_size,
+                                          static_cast<float>(behaviour.movement_range.y - origin.x) * pixel_size};
+          break;
+        case ObjectBehaviourType::VerticalMovement:
+          vertical = MovingPlatformAxis{true, static_cast<float>(behaviour.movement_range.x - origin.y) * pixel_size,
+                                        static_cast<float>(behaviour.movement_range.y - origin.y) * pixel_size};
+          break;
+        default:
+          BAIL;
+      }
+    }
+
+    reset();
+  }
+
+  void reset() {
+    // Spawn position, unless the configured range leaves it out.
+    offset = Vector2{start_offset(horizontal), start_offset(vertical)};
+    delta = vector_zero;
+    horizontal.direction = 1.f;
+    vertical.direction = 1.f;
+    recalculate_bounds();
+  }
+
+  void update() {
+    Vector2 prev_offset{offset};
+
+    offset.x = step_axis(&horizontal, offset.x);
+    offset.y = step_axis(&vertical, offset.y);
+
+    delta = Vector2Subtract(offset, prev_offset);
+    if (delta.x != 0.f || delta.y != 0.f) recalculate_bounds();
+  }
+
+  void draw() const {
+    for (auto const& elem : elems) {
+      elem.selection.draw(Vector2Add(elem.pos.scale(pixel_size).to_vector2(), offset), pixel_size);
+    }
+  }
+
+  /**
+   * Union of the element hitboxes at the current position. Used to skip the whole platform in one test.
+   */
+  Rectangle const& bounds() const {
+    return _bounds;
+  }
+
+  Rectangle const elem_hitbox(MovingPlatformElem const& elem) const {
+    return move(elem.selection.hitbox(elem.pos, pixel_size), offset);
+  }
+
+  /**
+   * Whether the element blocks a body moving towards the given side of it (same semantics as the hit map).
+   */
+  bool elem_collide_from(MovingPlatformElem const& elem, int direction) const {
+    return elem.selection.collide_from(direction);
+  }
+
+  std::vector<MovingPlatformElem> const& get_elems() const {
+    return elems;
+  }
+
+  /**
+   * How far the last update moves `body_hitbox`: the platform's movement if the body stands on top of it, or how deep a
+   * side moving into the body pushed it. Walls are not checked.
+   */
+  Vector2 push_delta(Rectangle const& body_hitbox) const {
+    if (delta.x == 0.f && delta.y == 0.f) return vector_zero;
+
+    Vector2 push{vector_zero};
+    for (auto const& elem : elems) {
+      Rectangle const hitbox{elem_hitbox(elem)};
+      Rectangle const prev_hitbox{move(hitbox, Vector2Scale(delta, -1.f))};
+
+      if (elem_collide_from(elem, COLLISION_TYPE_TOP) && is_horizontal_overlap(prev_hitbox, body_hitbox)) {
+        float gap = topy(prev_hitbox) - (bottomy(body_hitbox) + 1.f);
+        if (fabsf(gap) <= WALL_CHECK_THRESHOLD * pixel_size) return delta;
+      }
+
+      // Only a side that moved into the body pushes it, a body already inside is left alone.
+      if (!CheckCollisionRecs(hitbox, body_hitbox) || CheckCollisionRecs(prev_hitbox, body_hitbox)) continue;
+
+      // Same semantics as the hit map: the side facing the body blocks bodies moving towards it.
+      if (delta.x > 0.f && elem_collide_from(elem, COLLISION_TYPE_LEFT)) {
+        push.x = std::max(push.x, hitbox.x + hitbox.width - body_hitbox.x);
+      } else if (delta.x < 0.f && elem_collide_from(elem, COLLISION_TYPE_RIGHT)) {
+        push.x = std::min(push.x, hitbox.x - (body_hitbox.x + body_hitbox.width));
+      }
+      if (delta.y > 0.f && elem_collide_from(elem, COLLISION_TYPE_BOTTOM)) {
+        push.y = std::max(push.y, hitbox.y + hitbox.height - body_hitbox.y);
+      } else if (delta.y < 0.f && elem_collide_from(elem, COLLISION_TYPE_TOP)) {
+        push.y = std::min(push.y, hitbox.y - (body_hitbox.y + body_hitbox.height));
+      }
+    }
+
+    return push;
+  }
+
+ private:
+  int const pixel_size;
+  std::vector<MovingPlatformElem> elems;
+  MovingPlatformAxis horizontal{};
+  MovingPlatformAxis vertical{};
+  Vector2 offset{};
+  Vector2 delta{};
+  Rectangle _bounds{};
+
+  static float start_offset(MovingPlatformAxis const& axis) {
+    return axis.is_active ? std::clamp(0.f, axis.min_offset, axis.max_offset) : 0.f;
+  }
+
+  float step_axis(MovingPlatformAxis* axis, float value) {
+    if (!axis->is_active) return value;
+
+    value += axis->direction * MovingPlatformSpeed * pixel_size * GetFrameTime();
+    if (value >= axis->max_offset) {
+      value = axis->max_offset;
+      axis->direction = -1.f;
+    } else if (value <= axis->min_offset) {
+      value = axis->min_offset;
+      axis->direction = 1.f;
+    }
+
+    return value;
+  }
+
+  void recalculate_bounds() {
+    _bounds = elem_hitbox(elems.front());
+    for (auto const& elem : elems) {
+      Rectangle hitbox{elem_hitbox(elem)};
+      float min_x = std::min(_bounds.x, hitbox.x);
+      float min_y = std::min(_bounds.y, hitbox.y);
+      float max_x = std::max(_bounds.x + _bounds.width, hitbox.x + hitbox.width);
+      float max_y = std::max(_bounds.y + _bounds.height, hitbox.y + hitbox.height);
+      _bounds = Rectangle{min_x, min_y, max_x - min_x, max_y - min_y};
+    }
+  }
+};
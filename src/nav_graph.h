@@ -0,0 +1,508 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "collision_bitboard.h"
+#include "common.h"
+#include "player_physics.h"
+
+// Extra cost of a jump over walking the same distance, in tiles.
+constexpr float const NAV_JUMP_PENALTY{2.f};
+// Distance fields kept per target segment. All are dropped above this.
+constexpr size_t const NAV_DISTANCE_CACHE_CAPACITY{16};
+
+constexpr float const NAV_UNREACHABLE{std::numeric_limits<float>::infinity()};
+
+/**
+ * Maximal horizontal run of free cells standing on a floor, in tile coordinates.
+ */
+struct NavSegment {
+  int y;
+  int min_x;
+  int max_x;
+
+  bool operator==(NavSegment const& other) const {
+    return y == other.y && min_x == other.min_x && max_x == other.max_x;
+  }
+
+  float center_x() const {
+    return (min_x + max_x) * 0.5f;
+  }
+};
+
+enum class NavLinkType { Fall, Jump };
+
+struct NavLink {
+  NavLinkType type;
+  int from;
+  int to;
+  // Cell column the link leaves `from` at and arrives on `to` at.
+  int takeoff_x;
+  int landing_x;
+  float cost;
+
+  bool operator==(NavLink const& other) const {
+    return type == other.type && from == other.from && to == other.to && takeoff_x == other.takeoff_x &&
+           landing_x == other.landing_x && cost == other.cost;
+  }
+};
+
+/**
+ * Jump limits of the player physics in tiles: `max_height` tiles up, and for each height the farthest horizontal gap.
+ */
+struct NavJumpLimits {
+  int max_height{0};
+  std::vector<int> max_gap_by_height{};
+
+  static NavJumpLimits from_player_physics(int cell_size) {
+    constexpr float const dt{1.f / ReferenceFPS};
+
+    // Rising phase.
+    std::vector<float> rise_heights{};
+    float speed{PLAYER_JUMP_SPEED};
+    float height{0.f};
+    while (speed < -PLAYER_FALL_BACK_THRESHOLD) {
+      height -= speed * dt;
+      rise_heights.push_back(height);
+      speed *= PLAYER_GRAVITY;
+    }
+
+    NavJumpLimits limits{};
+    limits.max_height = static_cast<int>(height / cell_size);
+
+    for (int tiles = 0; tiles <= limits.max_height; tiles++) {
+      float target{static_cast<float>(tiles * cell_size)};
+
+      // Frames until the landing height is reached on the way down.
+      int frames{static_cast<int>(rise_heights.size())};
+      float fall_speed{PLAYER_FALL_BACK_THRESHOLD};
+      float fall_height{height};
+      while (fall_height > target) {
+        fall_height -= fall_speed * dt;
+        fall_speed = std::min(fall_speed * PLAYER_GRAVITY_INV, PLAYER_MAX_FALL_SPEED);
+        frames++;
+      }
+
+      float reach{PLAYER_MAX_REL_SPEED * frames * dt};
+      limits.max_gap_by_height.push_back(static_cast<int>(reach / cell_size));
+    }
+
+    return limits;
+  }
+};
+
+/**
+ * Platformer navigation over the static walls: surface segments connected by fall and jump links. Walking is movement
+ * inside a segment. Distances to a target segment are computed once and shared by every agent chasing it.
+ *
+ * Segment and link ids are slots that keep their place while the graph is edited, so a wall edit only re-derives the
+ * segments and links near it (`update_cell`).
+ */
+struct NavGraph {
+ public:
+  void build(CollisionBitboard const& walls, NavJumpLimits const& new_jump_limits) {
+    jump_limits = new_jump_limits;
+    width = walls.get_width();
+    height = walls.get_height();
+    segments.clear();
+    free_segments.clear();
+    rows.assign(height, {});
+    links.clear();
+    free_links.clear();
+    outgoing.clear();
+    incoming.clear();
+    distance_cache.clear();
+
+    for (int y = 0; y < height; y++) {
+      for (NavSegment const& seg : scan_row(walls, y)) add_segment(seg);
+    }
+    for (int from = 0; from < static_cast<int>(segments.size()); from++) {
+      for (NavLink const& link : links_from(walls, from)) add_link(link);
+    }
+  }
+
+  /**
+   * Catches up with a collision change of cell (x, y). Only the two rows whose standing cells depend on it are
+   * re-derived, and only the links that may start, land or pass near the changed cell are rebuilt. Distance fields a
+   * changed link could make shorter or longer are dropped, the others stay cached.
+   */
+  void update_cell(CollisionBitboard const& walls, int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) return;
+
+    std::vector<int> removed{};
+    std::vector<NavSegment> added{};
+    for (int row = std::max(0, y - 1); row <= y; row++) diff_row(walls, row, &removed, &added);
+
+    // Columns of the changed segments.
+    int min_x{x};
+    int max_x{x};
+    auto widen = [&](NavSegment const& seg) {
+      min_x = std::min(min_x, seg.min_x);
+      max_x = std::max(max_x, seg.max_x);
+    };
+
+    // Sources whose outgoing links are rebuilt. Links landing on a removed segment now land elsewhere.
+    std::vector<int> sources{};
+    for (int seg : removed) {
+      widen(segments[seg]);
+      for (int link_index : incoming[seg]) sources.push_back(links[link_index].from);
+    }
+    for (int seg : removed) remove_segment(seg);
+    for (NavSegment const& seg : added) {
+      widen(seg);
+      sources.push_back(add_segment(seg));
+    }
+
+    // Jumps can start `max_height` rows around a changed segment, or pass the cell on the way to the apex above the
+    // lower end of the jump.
+    int reach = jump_limits.max_gap_by_height.front() + 1;
+    int first_row = std::max(0, y - 1 - jump_limits.max_height);
+    int last_row = std::min(height - 1, y + 2 * jump_limits.max_height + 1);
+    for (int row = first_row; row <= last_row; row++) {
+      for (int seg : rows[row]) {
+        if (segments[seg].max_x + reach >= min_x && segments[seg].min_x - reach <= max_x) sources.push_back(seg);
+      }
+    }
+
+    // Falls off an edge over the cell's column.
+    for (int row = 0; row < first_row; row++) {
+      int left = segment_at(x + 1, row);
+      if (left != -1 && segments[left].min_x == x + 1) sources.push_back(left);
+      int right = segment_at(x - 1, row);
+      if (right != -1 && segments[right].max_x == x - 1) sources.push_back(right);
+    }
+
+    std::sort(sources.begin(), sources.end());
+    sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+    for (int from : sources) {
+      if (is_live(from)) rebuild_links_from(walls, from);
+    }
+  }
+
+  /**
+   * Segment whose cells contain (x, y), or -1.
+   */
+  int segment_at(int x, int y) const {
+    if (y < 0 || y >= height) return -1;
+
+    std::vector<int> const& row = rows[y];
+    auto it = std::upper_bound(row.begin(), row.end(), x,
+                               [&](int value, int seg) { return value < segments[seg].min_x; });
+    if (it == row.begin()) return -1;
+
+    --it;
+    return x <= segments[*it].max_x ? *it : -1;
+  }
+
+  /**
+   * Segment a body at (x, y) stands on or would land on when falling straight down, or -1.
+   */
+  int segment_below(CollisionBitboard const& walls, int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) return -1;
+
+    int segment = segment_at(x, y);
+    if (segment != -1) return segment;
+    return segment_at(x, walls.top_wall_below(x, y) - 1);
+  }
+
+  /**
+   * Horizontal direction (-1, 0 or 1) an agent in cell column `x` of segment `from` should move to get closest to
+   * column `target_x` of segment `to`. 0 means it is there, at the takeoff of its next link, or `to` is unreachable.
+   */
+  int direction(int from, int x, int to, int target_x) const {
+    if (from < 0 || to < 0) return 0;
+    if (from == to) return sign(target_x - x);
+
+    std::vector<float> const& distances = distances_to(to);
+    float best_cost{NAV_UNREACHABLE};
+    int best_takeoff_x{x};
+    for (int link_index : outgoing[from]) {
+      NavLink const& link = links[link_index];
+      if (distances[link.to] == NAV_UNREACHABLE) continue;
+
+      float cost = std::abs(x - link.takeoff_x) + link.cost + entry_cost(link, to, target_x) + distances[link.to];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_takeoff_x = link.takeoff_x;
+      }
+    }
+
+    return best_cost == NAV_UNREACHABLE ? 0 : sign(best_takeoff_x - x);
+  }
+
+ private:
+  int width{0};
+  int height{0};
+  NavJumpLimits jump_limits{};
+  // Slots, removed segments are marked by `y == -1` and listed in `free_segments`.
+  std::vector<NavSegment> segments{};
+  std::vector<int> free_segments{};
+  // Live segment ids of each row, sorted by column.
+  std::vector<std::vector<int>> rows{};
+  // Slots, removed links are listed in `free_links`.
+  std::vector<NavLink> links{};
+  std::vector<int> free_links{};
+  std::vector<std::vector<int>> outgoing{};
+  std::vector<std::vector<int>> incoming{};
+  // Cost from each segment's center to the target segment, keyed by target. Filled lazily by `distances_to`.
+  mutable std::unordered_map<int, std::vector<float>> distance_cache{};
+
+  static int sign(int v) {
+    return (v > 0) - (v < 0);
+  }
+
+  bool is_live(int seg) const {
+    return segments[seg].y != -1;
+  }
+
+  bool is_standable(CollisionBitboard const& walls, int x, int y) const {
+    if (walls.get(x, y) != COLLISION_TYPE_NOTHING) return false;
+    // The bottom edge of the map blocks like a floor.
+    return y + 1 >= height || (walls.get(x, y + 1) & COLLISION_TYPE_TOP) != 0;
+  }
+
+  std::vector<NavSegment> scan_row(CollisionBitboard const& walls, int y) const {
+    std::vector<NavSegment> row_segments{};
+    for (int x = 0; x < width; x++) {
+      if (!is_standable(walls, x, y)) continue;
+
+      int min_x = x;
+      while (x + 1 < width && is_standable(walls, x + 1, y)) x++;
+      row_segments.push_back(NavSegment{y, min_x, x});
+    }
+    return row_segments;
+  }
+
+  /**
+   * Compares row `y` against the walls: collects the segments that are gone and the ones that are new.
+   */
+  void diff_row(CollisionBitboard const& walls, int y, std::vector<int>* removed, std::vector<NavSegment>* added) {
+    std::vector<NavSegment> fresh{scan_row(walls, y)};
+    for (int seg : rows[y]) {
+      auto it = std::find(fresh.begin(), fresh.end(), segments[seg]);
+      if (it == fresh.end()) {
+        removed->push_back(seg);
+      } else {
+        fresh.erase(it);
+      }
+    }
+    added->insert(added->end(), fresh.begin(), fresh.end());
+  }
+
+  int add_segment(NavSegment const& seg) {
+    int id{static_cast<int>(segments.size())};
+    if (free_segments.empty()) {
+      segments.push_back(seg);
+      outgoing.emplace_back();
+      incoming.emplace_back();
+    } else {
+      id = free_segments.back();
+      free_segments.pop_back();
+      segments[id] = seg;
+    }
+
+    std::vector<int>& row = rows[seg.y];
+    row.insert(std::upper_bound(row.begin(), row.end(), seg.min_x,
+                                [&](int value, int other) { return value < segments[other].min_x; }),
+               id);
+    return id;
+  }
+
+  void remove_segment(int seg) {
+    forget_distances_through(seg);
+    distance_cache.erase(seg);
+    while (!outgoing[seg].empty()) remove_link(outgoing[seg].back());
+    while (!incoming[seg].empty()) remove_link(incoming[seg].back());
+
+    std::vector<int>& row = rows[segments[seg].y];
+    row.erase(std::find(row.begin(), row.end(), seg));
+    segments[seg] = NavSegment{-1, 0, -1};
+    free_segments.push_back(seg);
+  }
+
+  void add_link(NavLink const& link) {
+    forget_distances_through(link.to);
+
+    int id{static_cast<int>(links.size())};
+    if (free_links.empty()) {
+      links.push_back(link);
+    } else {
+      id = free_links.back();
+      free_links.pop_back();
+      links[id] = link;
+    }
+    outgoing[link.from].push_back(id);
+    incoming[link.to].push_back(id);
+  }
+
+  void remove_link(int id) {
+    NavLink const& link = links[id];
+    forget_distances_through(link.to);
+    std::erase(outgoing[link.from], id);
+    std::erase(incoming[link.to], id);
+    free_links.push_back(id);
+  }
+
+  /**
+   * Replaces the outgoing links of `from` with the ones the walls give now. Unchanged links are kept.
+   */
+  void rebuild_links_from(CollisionBitboard const& walls, int from) {
+    std::vector<NavLink> fresh{links_from(walls, from)};
+    std::vector<int> stale{};
+    for (int link_index : outgoing[from]) {
+      auto it = std::find(fresh.begin(), fresh.end(), links[link_index]);
+      if (it == fresh.end()) {
+        stale.push_back(link_index);
+      } else {
+        fresh.erase(it);
+      }
+    }
+
+    for (int link_index : stale) remove_link(link_index);
+    for (NavLink const& link : fresh) add_link(link);
+  }
+
+  /**
+   * Drops the distance fields a link into `seg` takes part in. Links into unreachable segments change no distance.
+   */
+  void forget_distances_through(int seg) {
+    std::erase_if(distance_cache, [&](auto const& entry) {
+      std::vector<float> const& distances = entry.second;
+      return seg < static_cast<int>(distances.size()) && distances[seg] != NAV_UNREACHABLE;
+    });
+  }
+
+  std::vector<NavLink> links_from(CollisionBitboard const& walls, int from) const {
+    std::vector<NavLink> out{};
+    NavSegment const& seg = segments[from];
+    add_fall_link(walls, from, seg.min_x, seg.min_x - 1, COLLISION_TYPE_LEFT, &out);
+    add_fall_link(walls, from, seg.max_x, seg.max_x + 1, COLLISION_TYPE_RIGHT, &out);
+    add_jump_links(walls, from, &out);
+    return out;
+  }
+
+  void add_fall_link(CollisionBitboard const& walls, int from, int takeoff_x, int edge_x, int blocking_direction,
+                     std::vector<NavLink>* out) const {
+    int y = segments[from].y;
+    if (edge_x < 0 || edge_x >= width) return;
+    if (walls.get(edge_x, y) & blocking_direction) return;
+
+    int landing_y = walls.top_wall_below(edge_x, y) - 1;
+    int to = segment_at(edge_x, landing_y);
+    if (to == -1 || to == from) return;
+
+    float cost = static_cast<float>(std::abs(edge_x - takeoff_x) + (landing_y - y));
+    out->push_back(NavLink{NavLinkType::Fall, from, to, takeoff_x, edge_x, cost});
+  }
+
+  void add_jump_links(CollisionBitboard const& walls, int from, std::vector<NavLink>* out) const {
+    NavSegment const& seg = segments[from];
+
+    // Drops get the reach of a level jump, falling further only adds to it.
+    for (int dy = -jump_limits.max_height; dy <= jump_limits.max_height; dy++) {
+      int y = seg.y + dy;
+      if (y < 0 || y >= height) continue;
+      int rise = std::max(0, -dy);
+
+      for (int to : rows[y]) {
+        if (to == from) continue;
+        NavSegment const& target = segments[to];
+
+        if (target.max_x < seg.min_x) {
+          add_jump_link(walls, from, to, seg.min_x, target.max_x, rise, out);
+        } else if (target.min_x > seg.max_x) {
+          add_jump_link(walls, from, to, seg.max_x, target.min_x, rise, out);
+        } else if (dy < 0) {
+          // Overhead, jump up from just beside it. Bodies cannot jump up through its floor.
+          if (target.min_x - 1 >= seg.min_x) add_jump_link(walls, from, to, target.min_x - 1, target.min_x, rise, out);
+          if (target.max_x + 1 <= seg.max_x) add_jump_link(walls, from, to, target.max_x + 1, target.max_x, rise, out);
+        }
+      }
+    }
+  }
+
+  void add_jump_link(CollisionBitboard const& walls, int from, int to, int takeoff_x, int landing_x, int rise,
+                     std::vector<NavLink>* out) const {
+    int gap = std::abs(landing_x - takeoff_x);
+    if (gap > jump_limits.max_gap_by_height[rise]) return;
+
+    // Headroom over the takeoff, up to the landing row.
+    int from_y = segments[from].y;
+    if (walls.bottom_wall_above(takeoff_x, from_y) >= std::min(segments[to].y, from_y)) return;
+    if (!is_jump_path_clear(walls, from, to, takeoff_x, landing_x)) return;
+
+    float cost = static_cast<float>(gap + rise) + NAV_JUMP_PENALTY;
+    out->push_back(NavLink{NavLinkType::Jump, from, to, takeoff_x, landing_x, cost});
+  }
+
+  /**
+   * Whether every column between the takeoff and the landing can be crossed: some cell from the jump apex down to the
+   * landing row does not block movement towards the landing.
+   */
+  bool is_jump_path_clear(CollisionBitboard const& walls, int from, int to, int takeoff_x, int landing_x) const {
+    int step = sign(landing_x - takeoff_x);
+    int blocking_direction = step > 0 ? COLLISION_TYPE_RIGHT : COLLISION_TYPE_LEFT;
+    int landing_y = segments[to].y;
+    int apex_y = std::max(0, std::min(segments[from].y, landing_y) - jump_limits.max_height);
+
+    for (int x = takeoff_x + step; x != landing_x; x += step) {
+      bool is_open{false};
+      for (int y = apex_y; y <= landing_y && !is_open; y++) is_open = (walls.get(x, y) & blocking_direction) == 0;
+      if (!is_open) return false;
+    }
+    return true;
+  }
+
+  float entry_cost(NavLink const& link, int target, int target_x) const {
+    if (link.to == target) return std::abs(link.landing_x - target_x);
+    return std::abs(link.landing_x - segments[link.to].center_x());
+  }
+
+  /**
+   * Dijkstra from `target` over the reversed links.
+   */
+  std::vector<float> const& distances_to(int target) const {
+    auto cached = distance_cache.find(target);
+    if (cached != distance_cache.end()) {
+      // Segments added since the field was computed cannot reach the target, or the field would have been dropped.
+      cached->second.resize(segments.size(), NAV_UNREACHABLE);
+      return cached->second;
+    }
+
+    if (distance_cache.size() >= NAV_DISTANCE_CACHE_CAPACITY) distance_cache.clear();
+    std::vector<float>& distances = distance_cache[target];
+    distances.assign(segments.size(), NAV_UNREACHABLE);
+
+    using QueueItem = std::pair<float, int>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue{};
+    distances[target] = 0.f;
+    queue.push({0.f, target});
+
+    while (!queue.empty()) {
+      auto [distance, segment] = queue.top();
+      queue.pop();
+      if (distance > distances[segment]) continue;
+
+      for (int link_index : incoming[segment]) {
+        NavLink const& link = links[link_index];
+        float from_cost = std::abs(segments[link.from].center_x() - link.takeoff_x) + link.cost +
+                          entry_cost(link, target, static_cast<int>(segments[target].center_x()));
+        float candidate = distance + from_cost;
+        if (candidate < distances[link.from]) {
+          distances[link.from] = candidate;
+          queue.push({candidate, link.from});
+        }
+      }
+    }
+
+    return distances;
+  }
+};
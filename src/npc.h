@@ -10,11 +10,10 @@
 #include "map.h"
 #include "raylib.h"
 #include "raymath.h"
+#include "rect_batch.h"
 #include "sprite.h"
 #include "sprite_group.h"
 
-constexpr Vector2 const ChargingNpcSize{48.f, 48.f};
-
 constexpr size_t const SimpleWalkNpcSpriteFall{0};
 constexpr size_t const SimpleWalkNpcSpriteHit{1};
 constexpr size_t const SimpleWalkNpcSpriteIdle{2};
@@ -41,87 +40,81 @@ constexpr float const SimpleWalkNpcSpeed{200.f};
 constexpr float const ChargingNpcWalkSpeed{100.f};
 constexpr float const ChargingNpcChargeSpeed{300.f};
 constexpr float const ShootingNpcSpeed{200.f};
+// Unscaled map pixels.
+constexpr float const SimpleWalkNpcChaseDistance{TILE_SIZE * 10};
 
 enum class SimpleWalkNpcState { Idle, Run, Hit };
 
 struct Npc {
  public:
   virtual void draw() const = 0;
-  virtual void update(Map const& map, Character& character) = 0;
+  /**
+   * `walls` holds the `Map` wall queries of `hitbox()` taken at the start of the tick.
+   */
+  virtual void update(Map const& map, Character& character, WallBounds const& walls) = 0;
   virtual Rectangle hitbox() const = 0;
+  // Moves the npc without any check, e.g. by `Map::platform_carry`.
+  virtual void displace(Vector2 const offset) = 0;
   virtual void injure() = 0;
   virtual bool is_injured() const = 0;
+  virtual void reset() = 0;
 
   virtual ~Npc() = default;
 };
 
+AnimationPrototype simple_walk_npc_animation_prototype(TileSource const tile_source) {
+  switch (tile_source) {
+    case TileSource::Enemy1:
+      return AnimationPrototype::Enemy1;
+    case TileSource::Enemy2:
+      return AnimationPrototype::Enemy2;
+    default:
+      BAILF("Invalid: %d", tile_source);
+  }
+}
+
 struct SimpleWalkNpc : Npc {
  public:
   SimpleWalkNpc(IntVec2 const pos, TileSource const tile_source, int const pixel_size)
-      : pos(pos.scale(pixel_size).to_vector2()), pixel_size(pixel_size), tile_source(tile_source) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-
-    switch (tile_source) {
-      case TileSource::Enemy1:
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy1__Fall], SIMPLE_WALK_NPC_SIZE, 3,
-                                        sprite_frame_length});
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy1__Hit], SIMPLE_WALK_NPC_SIZE, 5,
-                                        sprite_frame_length});
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy1__Idle], SIMPLE_WALK_NPC_SIZE, 11,
-                                        sprite_frame_length});
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy1__Jump], SIMPLE_WALK_NPC_SIZE, 3,
-                                        sprite_frame_length});
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy1__Run], SIMPLE_WALK_NPC_SIZE, 12,
-                                        sprite_frame_length});
-
-        break;
-      case TileSource::Enemy2:
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy2__Fall], SIMPLE_WALK_NPC_SIZE, 1,
-                                        sprite_frame_length});
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy2__Hit], SIMPLE_WALK_NPC_SIZE, 5,
-                                        sprite_frame_length});
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy2__Idle], SIMPLE_WALK_NPC_SIZE, 11,
-                                        sprite_frame_length});
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy2__Jump], SIMPLE_WALK_NPC_SIZE, 1,
-                                        sprite_frame_length});
-        sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                        asset_manager.textures[TextureNames::Enemy2__Run], SIMPLE_WALK_NPC_SIZE, 12,
-                                        sprite_frame_length});
-
-        break;
-      default:
-        BAILF("Invalid: %d", tile_source);
-    }
-
-    sprite_group.set_current_sprite(SimpleWalkNpcSpriteRun);
+      : spawn_pos(pos.scale(pixel_size).to_vector2()),
+        pixel_size(pixel_size),
+        sprite_group(simple_walk_npc_animation_prototype(tile_source), static_cast<float>(pixel_size)),
+        tile_source(tile_source) {
+    reset();
   }
 
   ~SimpleWalkNpc() = default;
 
+  void reset() override {
+    pos = spawn_pos;
+    speed = Vector2{-SimpleWalkNpcSpeed, 0.f};
+    state = SimpleWalkNpcState::Run;
+    movement_timeout.cancel();
+    movement_timer.reset();
+    sprite_group.reset();
+    sprite_group.set_current_sprite(SimpleWalkNpcSpriteRun);
+  }
+
   void draw() const override {
     sprite_group.draw(pos);
     // DrawRectangleLinesEx(hitbox(), pixel_size, RED);
   }
 
-  void update(Map const& map, Character& character) override {
+  void update(Map const& map, Character& character, WallBounds const& walls) override {
     movement_timeout.update();
-    sprite_group.update();
 
     if (state == SimpleWalkNpcState::Run) {
       Rectangle _hitbox = hitbox();
-      int west_wall = map.west_wall_of_range(_hitbox);
-      int east_wall = map.east_wall_of_range(_hitbox);
+      if (chase(map, character, _hitbox)) {
+        sprite_group.set_current_sprite(SimpleWalkNpcSpriteIdle);
+        return;
+      }
+      sprite_group.set_current_sprite(SimpleWalkNpcSpriteRun);
+
+      int west_wall = walls.west;
+      int east_wall = walls.east;
 
-      pos.x += speed.x * GetFrameTime();
+      pos.x += speed.x * UpdateDeltaTime;
       _hitbox = hitbox();
 
       // Handle walls.
@@ -159,6 +152,10 @@ struct SimpleWalkNpc : Npc {
     return move(upscale(tile_source_hitbox(tile_source), pixel_size), pos);
   }
 
+  void displace(Vector2 const offset) override {
+    pos = Vector2Add(pos, offset);
+  }
+
   void injure() override {
     sprite_group.set_current_sprite(SimpleWalkNpcSpriteHit);
     state = SimpleWalkNpcState::Hit;
@@ -172,10 +169,11 @@ struct SimpleWalkNpc : Npc {
   }
 
  private:
+  Vector2 const spawn_pos;
   Vector2 pos;
   Vector2 speed{-SimpleWalkNpcSpeed, 0.f};
   int const pixel_size;
-  SpriteGroup sprite_group{};
+  SpriteGroup sprite_group;
   SimpleWalkNpcState state{SimpleWalkNpcState::Run};
   Timeout movement_timeout{};
   RepeatTimer movement_timer{0.3};
@@ -195,6 +193,27 @@ struct SimpleWalkNpc : Npc {
       speed.x = -SimpleWalkNpcSpeed;
     }
   }
+
+  /**
+   * Turns towards a nearby character along the map's navigation graph. Patrols as before otherwise. Returns true when
+   * the chase has nowhere to walk, e.g. at the takeoff of a jump it cannot make, and it should hold its position.
+   */
+  bool chase(Map const& map, Character const& character, Rectangle const& self_hitbox) {
+    if (!character.is_live()) return false;
+
+    Rectangle character_hitbox{character.hitbox()};
+    float chase_distance = SimpleWalkNpcChaseDistance * pixel_size;
+    if (fabsf(character_hitbox.x - self_hitbox.x) > chase_distance ||
+        fabsf(character_hitbox.y - self_hitbox.y) > chase_distance) {
+      return false;
+    }
+
+    int direction = map.nav_direction(self_hitbox, character_hitbox);
+    if (direction == 0) return true;
+
+    if ((direction > 0) != (speed.x > 0)) turn_horizontally();
+    return false;
+  }
 };
 
 enum class ChargingNpcState {
@@ -206,45 +225,44 @@ enum class ChargingNpcState {
 
 struct ChargingNpc : Npc {
  public:
-  ChargingNpc(Vector2 const pos, int const pixel_size) : pos(pos), pixel_size(pixel_size) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                    asset_manager.textures[TextureNames::Enemy3__Charge], ChargingNpcSize, 12,
-                                    sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy3__Hit],
-                                    ChargingNpcSize, 5, sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy3__Idle],
-                                    ChargingNpcSize, 11, sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy3__Stun],
-                                    ChargingNpcSize, 8, sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy3__Walk],
-                                    ChargingNpcSize, 12, sprite_frame_length});
-
-    sprite_group.set_current_sprite(ChargingNpcSpriteWalk);
+  ChargingNpc(Vector2 const pos, int const pixel_size)
+      : spawn_pos(pos),
+        pixel_size(pixel_size),
+        sprite_group(AnimationPrototype::Enemy3, static_cast<float>(pixel_size)) {
+    reset();
   }
 
   ~ChargingNpc() = default;
 
+  void reset() override {
+    pos = spawn_pos;
+    is_direction_left = true;
+    state = ChargingNpcState::Walking;
+    charge_stunned_timeout.cancel();
+    hit_timeout.cancel();
+    sprite_group.reset();
+    sprite_group.set_current_sprite(ChargingNpcSpriteWalk);
+  }
+
   void draw() const override {
     sprite_group.draw(pos);
   }
 
-  void update(Map const& map, Character& character) override {
-    sprite_group.update();
+  void update(Map const& map, Character& character, WallBounds const& walls) override {
     charge_stunned_timeout.update();
     hit_timeout.update();
 
     Rectangle _hitbox = hitbox();
-    int west_wall = map.west_wall_of_range(_hitbox);
-    int east_wall = map.east_wall_of_range(_hitbox);
+    int west_wall = walls.west;
+    int east_wall = walls.east;
 
-    pos.x += speed() * GetFrameTime() * (is_direction_left ? -1.f : 1.f);
+    pos.x += speed() * UpdateDeltaTime * (is_direction_left ? -1.f : 1.f);
     _hitbox = hitbox();
 
     if (is_walking()) {
       Rectangle character_hitbox{character.hitbox()};
-      if (can_charge_character_horizontal(west_wall, east_wall, _hitbox, character_hitbox)) {
+      if (can_charge_character_horizontal(west_wall, east_wall, _hitbox, character_hitbox) &&
+          map.has_line_of_sight(_hitbox, character_hitbox)) {
         state = ChargingNpcState::Charging;
         sprite_group.set_current_sprite(ChargingNpcSpriteCharge);
         if (character_hitbox.x <= _hitbox.x) {  // Charge left.
@@ -296,6 +314,10 @@ struct ChargingNpc : Npc {
     return move(upscale(tile_source_hitbox(TileSource::Enemy3), pixel_size), pos);
   }
 
+  void displace(Vector2 const offset) override {
+    pos = Vector2Add(pos, offset);
+  }
+
   void injure() override {
     state = ChargingNpcState::Hit;
     sprite_group.set_current_sprite(ChargingNpcSpriteHit);
@@ -314,9 +336,10 @@ struct ChargingNpc : Npc {
   }
 
  private:
+  Vector2 const spawn_pos;
   Vector2 pos;
   int const pixel_size;
-  SpriteGroup sprite_group{};
+  SpriteGroup sprite_group;
   bool is_direction_left{true};
   Timeout charge_stunned_timeout{};
   ChargingNpcState state{ChargingNpcState::Walking};
@@ -354,18 +377,21 @@ enum class ShootingNpcState {
 
 struct ShootingNpc : Npc {
  public:
-  ShootingNpc(Vector2 const pos, int const pixel_size) : pos(pos), pixel_size(pixel_size) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
+  ShootingNpc(Vector2 const pos, int const pixel_size)
+      : spawn_pos(pos),
+        pixel_size(pixel_size),
+        sprite_group(AnimationPrototype::Enemy4, static_cast<float>(pixel_size)) {
+    reset();
+  }
 
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                    asset_manager.textures[TextureNames::Enemy4__Attack], ChargingNpcSize, 7,
-                                    sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy4__Hit],
-                                    ChargingNpcSize, 5, sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy4__Idle],
-                                    ChargingNpcSize, 11, sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy4__Walk],
-                                    ChargingNpcSize, 12, sprite_frame_length});
+  void reset() override {
+    pos = spawn_pos;
+    is_direction_left = true;
+    state = ShootingNpcState::Walk;
+    hit_timeout.cancel();
+    bullets.clear();
+    sprite_group.reset();
+    sprite_group.set_current_sprite(ShootingNpcSpriteWalk);
   }
 
   void draw() const override {
@@ -373,30 +399,41 @@ struct ShootingNpc : Npc {
     for (auto const& bullet : bullets) bullet.draw();
   }
 
-  void update(Map const& map, Character& character) override {
+  void update(Map const& map, Character& character, WallBounds const& walls) override {
     int sprite_group_sequence = sprite_group.update();
     hit_timeout.update();
 
+    bullet_hitboxes.clear();
     for (auto& bullet : bullets) {
       bullet.update();
-      if (CheckCollisionRecs(character.hitbox(), bullet.hitbox())) {
+      bullet_hitboxes.push(bullet.hitbox());
+    }
+
+    overlap_one_to_many(character.hitbox(), bullet_hitboxes, &bullet_hit_mask);
+    size_t bullet_index{0};
+    for (auto& bullet : bullets) {
+      if (rect_batch_mask_test(bullet_hit_mask, bullet_index++)) {
         character.injure();
         bullet.set_target_hit();
       }
     }
+    for (auto const& bullet : bullets) {
+      if (bullet.is_dead()) bullet.emit_impact();
+    }
     std::erase_if(bullets, [](auto const& bullet) { return bullet.is_dead(); });
 
     Rectangle _hitbox = hitbox();
-    int west_wall = map.west_wall_of_range(_hitbox);
-    int east_wall = map.east_wall_of_range(_hitbox);
+    int west_wall = walls.west;
+    int east_wall = walls.east;
 
     float speed = state == ShootingNpcState::Walk ? ShootingNpcSpeed : 0.f;
-    pos.x += speed * GetFrameTime() * (is_direction_left ? -1.f : 1.f);
+    pos.x += speed * UpdateDeltaTime * (is_direction_left ? -1.f : 1.f);
     _hitbox = hitbox();
     Rectangle character_hitbox{character.hitbox()};
 
     if (state == ShootingNpcState::Walk) {
-      if (!character.is_injured() && can_charge_character_horizontal(west_wall, east_wall, _hitbox, character_hitbox)) {
+      if (!character.is_injured() && can_charge_character_horizontal(west_wall, east_wall, _hitbox, character_hitbox) &&
+          map.has_line_of_sight(_hitbox, character_hitbox)) {
         state = ShootingNpcState::Attack;
         sprite_group.set_current_sprite(ShootingNpcSpriteAttack);
         if (character_hitbox.x <= _hitbox.x) {  // Charge left.
@@ -415,7 +452,7 @@ struct ShootingNpc : Npc {
       }
       if (sprite_group_sequence == 0) {
         if (!can_charge_character_horizontal(west_wall, east_wall, _hitbox, character_hitbox) ||
-            character.is_injured()) {
+            !map.has_line_of_sight(_hitbox, character_hitbox) || character.is_injured()) {
           state = ShootingNpcState::Walk;
           sprite_group.set_current_sprite(ShootingNpcSpriteWalk);
         }
@@ -444,6 +481,10 @@ struct ShootingNpc : Npc {
     return move(upscale(tile_source_hitbox(TileSource::Enemy4), pixel_size), pos);
   }
 
+  void displace(Vector2 const offset) override {
+    pos = Vector2Add(pos, offset);
+  }
+
   void injure() override {
     hit_timeout.cancel();
     state = ShootingNpcState::Hit;
@@ -463,13 +504,16 @@ struct ShootingNpc : Npc {
   ~ShootingNpc() = default;
 
  private:
+  Vector2 const spawn_pos;
   Vector2 pos;
   int const pixel_size;
-  SpriteGroup sprite_group{};
+  SpriteGroup sprite_group;
   bool is_direction_left{true};
   Timeout hit_timeout{};
   ShootingNpcState state{ShootingNpcState::Walk};
   std::list<Bullet> bullets{};
+  RectBatch bullet_hitboxes{};
+  std::vector<uint64_t> bullet_hit_mask{};
 
   Vector2 bullet_spawn_point() const {
     if (is_direction_left) {
@@ -489,19 +533,18 @@ enum class StompingNpcState {
 
 struct StompingNpc : Npc {
  public:
-  StompingNpc(Vector2 const pos, int const pixel_size) : pos(pos), pixel_size(pixel_size) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size),
-                                    asset_manager.textures[TextureNames::Enemy5__Attack], ChargingNpcSize, 8,
-                                    sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy5__Fly],
-                                    ChargingNpcSize, 6, sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy5__Hit],
-                                    ChargingNpcSize, 5, sprite_frame_length});
-    sprite_group.push_sprite(Sprite{static_cast<float>(pixel_size), asset_manager.textures[TextureNames::Enemy5__Idle],
-                                    ChargingNpcSize, 6, sprite_frame_length});
+  StompingNpc(Vector2 const pos, int const pixel_size)
+      : spawn_pos(pos),
+        pixel_size(pixel_size),
+        sprite_group(AnimationPrototype::Enemy5, static_cast<float>(pixel_size)) {
+    reset();
+  }
 
+  void reset() override {
+    pos = spawn_pos;
+    state = StompingNpcState::Fly;
+    hit_timeout.cancel();
+    sprite_group.reset();
     sprite_group.set_current_sprite(StompingNpcSpriteFly);
   }
 
@@ -509,20 +552,20 @@ struct StompingNpc : Npc {
     sprite_group.draw(pos);
   }
 
-  void update(Map const& map, Character& character) override {
-    sprite_group.update();
+  void update(Map const& map, Character& character, WallBounds const& walls) override {
     hit_timeout.update();
 
     Rectangle _hitbox = hitbox();
-    int north_wall = map.north_wall_of_range(_hitbox);
-    int south_wall = map.south_wall_of_range(_hitbox);
+    int north_wall = walls.north;
+    int south_wall = walls.south;
 
-    pos.y += speed() * GetFrameTime();
+    pos.y += speed() * UpdateDeltaTime;
     _hitbox = hitbox();
     Rectangle character_hitbox{character.hitbox()};
 
     if (state == StompingNpcState::Idle) {
-      if (can_charge_character_vertical(south_wall, _hitbox, character_hitbox)) {
+      if (can_charge_character_vertical(south_wall, _hitbox, character_hitbox) &&
+          map.has_line_of_sight(_hitbox, character_hitbox)) {
         state = StompingNpcState::Attack;
         sprite_group.set_current_sprite(StompingNpcSpriteAttack);
       }
@@ -550,6 +593,10 @@ struct StompingNpc : Npc {
     return move(upscale(tile_source_hitbox(TileSource::Enemy5), pixel_size), pos);
   }
 
+  void displace(Vector2 const offset) override {
+    pos = Vector2Add(pos, offset);
+  }
+
   void injure() override {
     hit_timeout.cancel();
     state = StompingNpcState::Hit;
@@ -569,9 +616,10 @@ struct StompingNpc : Npc {
   ~StompingNpc() = default;
 
  private:
+  Vector2 const spawn_pos;
   Vector2 pos;
   int const pixel_size;
-  SpriteGroup sprite_group{};
+  SpriteGroup sprite_group;
   Timeout hit_timeout{};
   StompingNpcState state{StompingNpcState::Fly};
 
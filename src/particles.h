@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "common.h"
+#include "raylib.h"
+#include "rect_batch.h"
+#include "rlgl.h"
+
+// Live particles at most. Bursts beyond it are cut short, the pool never grows.
+constexpr size_t const PARTICLE_CAPACITY{100000};
+// Downward acceleration in unscaled map pixels per second squared.
+constexpr float const PARTICLE_GRAVITY{600.f};
+
+/**
+ * Shape of one burst of particles. Speeds are in unscaled map pixels per second, angles in degrees with 0 pointing
+ * right and -90 up.
+ */
+struct ParticleBurst {
+  int count;
+  float min_speed;
+  float max_speed;
+  float angle;
+  float spread;
+  float min_life;
+  float max_life;
+  float size;
+  Color color;
+};
+
+constexpr ParticleBurst const ParticleBurstCharacterHit{24, 60.f, 160.f, -90.f, 360.f, 0.3f, 0.6f, 2.f, RED};
+constexpr ParticleBurst const ParticleBurstLand{10, 20.f, 60.f, -90.f, 140.f, 0.2f, 0.35f, 1.f, LIGHTGRAY};
+constexpr ParticleBurst const ParticleBurstBulletImpact{8, 40.f, 120.f, -90.f, 360.f, 0.15f, 0.3f, 1.f, ORANGE};
+constexpr ParticleBurst const ParticleBurstCrumble{16, 10.f, 40.f, 90.f, 120.f, 0.4f, 0.8f, 2.f, BROWN};
+
+/**
+ * Fixed pool of short-lived squares in structure-of-arrays layout. The update kernel advances position, velocity and
+ * lifetime for all lanes at once; dead particles are swapped out with the last live one. Everything is drawn in one
+ * untextured quad batch.
+ */
+struct ParticleSystem {
+ public:
+  ParticleSystem() {
+    size_t const padded_capacity = (PARTICLE_CAPACITY + RECT_BATCH_LANES - 1) / RECT_BATCH_LANES * RECT_BATCH_LANES;
+    xs.resize(padded_capacity);
+    ys.resize(padded_capacity);
+    vxs.resize(padded_capacity);
+    vys.resize(padded_capacity);
+    lives.resize(padded_capacity);
+    sizes.resize(padded_capacity);
+    colors.resize(padded_capacity);
+  }
+
+  /**
+   * Spawns `burst` around `pos` (map coordinates, already scaled by `pixel_size`).
+   */
+  void emit(ParticleBurst const& burst, Vector2 const pos, int const pixel_size) {
+    for (int n = 0; n < burst.count && count < PARTICLE_CAPACITY; n++) {
+      float angle = (burst.angle + (randf() - 0.5f) * burst.spread) * DEG2RAD;
+      float speed = (burst.min_speed + randf() * (burst.max_speed - burst.min_speed)) * pixel_size;
+
+      xs[count] = pos.x;
+      ys[count] = pos.y;
+      vxs[count] = cosf(angle) * speed;
+      vys[count] = sinf(angle) * speed;
+      lives[count] = burst.min_life + randf() * (burst.max_life - burst.min_life);
+      sizes[count] = burst.size * pixel_size;
+      colors[count] = burst.color;
+      count++;
+    }
+  }
+
+  void update(int const pixel_size) {
+    float const dt = GetFrameTime();
+    float const gravity_step = PARTICLE_GRAVITY * pixel_size * dt;
+
+    integrate(dt, gravity_step);
+
+    for (size_t i = 0; i < count;) {
+      if (lives[i] > 0.f) {
+        i++;
+        continue;
+      }
+
+      count--;
+      xs[i] = xs[count];
+      ys[i] = ys[count];
+      vxs[i] = vxs[count];
+      vys[i] = vys[count];
+      lives[i] = lives[count];
+      sizes[i] = sizes[count];
+      colors[i] = colors[count];
+    }
+  }
+
+  void draw() const {
+    if (count == 0) return;
+
+    rlSetTexture(rlGetTextureIdDefault());
+    rlBegin(RL_QUADS);
+    for (size_t i = 0; i < count; i++) {
+      float const x = xs[i];
+      float const y = ys[i];
+      float const size = sizes[i];
+
+      rlColor4ub(colors[i].r, colors[i].g, colors[i].b, colors[i].a);
+      rlVertex2f(x, y);
+      rlVertex2f(x, y + size);
+      rlVertex2f(x + size, y + size);
+      rlVertex2f(x + size, y);
+    }
+    rlEnd();
+    rlSetTexture(0);
+  }
+
+  void clear() {
+    count = 0;
+  }
+
+  size_t size() const {
+    return count;
+  }
+
+ private:
+  size_t count{0};
+  std::vector<float> xs{};
+  std::vector<float> ys{};
+  std::vector<float> vxs{};
+  std::vector<float> vys{};
+  // Seconds left to live.
+  std::vector<float> lives{};
+  std::vector<float> sizes{};
+  std::vector<Color> colors{};
+
+  /**
+   * Advances every lane up to `count` rounded to the lane width. The lanes past `count` hold stale data and are
+   * never read.
+   */
+  void integrate(float const dt, float const gravity_step) {
+    size_t const padded_count = (count + RECT_BATCH_LANES - 1) / RECT_BATCH_LANES * RECT_BATCH_LANES;
+    float* x = xs.data();
+    float* y = ys.data();
+    float* vx = vxs.data();
+    float* vy = vys.data();
+    float* life = lives.data();
+
+#if defined(__AVX2__)
+    __m256 const v_dt = _mm256_set1_ps(dt);
+    __m256 const v_gravity_step = _mm256_set1_ps(gravity_step);
+
+    for (size_t i = 0; i < padded_count; i += 8) {
+      __m256 v_vy = _mm256_add_ps(_mm256_loadu_ps(vy + i), v_gravity_step);
+      _mm256_storeu_ps(vy + i, v_vy);
+      _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), v_dt)));
+      _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(v_vy, v_dt)));
+      _mm256_storeu_ps(life + i, _mm256_sub_ps(_mm256_loadu_ps(life + i), v_dt));
+    }
+#elif defined(__SSE2__)
+    __m128 const v_dt = _mm_set1_ps(dt);
+    __m128 const v_gravity_step = _mm_set1_ps(gravity_step);
+
+    for (size_t i = 0; i < padded_count; i += 4) {
+      __m128 v_vy = _mm_add_ps(_mm_loadu_ps(vy + i), v_gravity_step);
+      _mm_storeu_ps(vy + i, v_vy);
+      _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(vx + i), v_dt)));
+      _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(v_vy, v_dt)));
+      _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), v_dt));
+    }
+#else
+    for (size_t i = 0; i < padded_count; i++) {
+      vy[i] += gravity_step;
+      x[i] += vx[i] * dt;
+      y[i] += vy[i] * dt;
+      life[i] -= dt;
+    }
+#endif
+  }
+};
+
+static ParticleSystem particles{};
@@ -0,0 +1,12 @@
+#pragma once
+
+// Speeds are screen pixels per second, multipliers are per `ReferenceFPS` frame.
+constexpr float PLAYER_MAX_REL_SPEED = 500.f;
+constexpr float PLAYER_MOVEMENT_FRICTION = 0.9f;
+constexpr float PLAYER_ZERO_SPEED_THRESHOLD = 0.1f;
+constexpr float PLAYER_JUMP_SPEED = -750.f;
+constexpr float PLAYER_GRAVITY = 0.96f;
+constexpr float PLAYER_GRAVITY_INV = 1.f / PLAYER_GRAVITY;
+constexpr float PLAYER_FALL_BACK_THRESHOLD = 100.f;
+constexpr float PLAYER_MAX_FALL_SPEED = PLAYER_MAX_REL_SPEED;
+constexpr float PLAYER_MULTI_JUMP_MAX = 2;
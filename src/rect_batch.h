@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "raylib.h"
+
+// Lanes processed per iteration; buffers are padded to a multiple of it so the kernels never need a scalar tail.
+constexpr size_t const RECT_BATCH_LANES{8};
+
+/**
+ * Structure-of-arrays buffer of rectangles, stored as edges. Keeps its capacity across `clear()` calls so it can be
+ * refilled every frame without allocating.
+ */
+struct RectBatch {
+ public:
+  void clear() {
+    count = 0;
+    lefts.clear();
+    tops.clear();
+    rights.clear();
+    bottoms.clear();
+  }
+
+  void push(Rectangle const& rect) {
+    if (count == lefts.size()) {
+      // Padding never overlaps anything.
+      lefts.resize(count + RECT_BATCH_LANES, INFINITY);
+      tops.resize(count + RECT_BATCH_LANES, INFINITY);
+      rights.resize(count + RECT_BATCH_LANES, -INFINITY);
+      bottoms.resize(count + RECT_BATCH_LANES, -INFINITY);
+    }
+
+    lefts[count] = rect.x;
+    tops[count] = rect.y;
+    rights[count] = rect.x + rect.width;
+    bottoms[count] = rect.y + rect.height;
+    count++;
+  }
+
+  size_t size() const {
+    return count;
+  }
+
+  size_t padded_size() const {
+    return lefts.size();
+  }
+
+  Rectangle get(size_t i) const {
+    return Rectangle{lefts[i], tops[i], rights[i] - lefts[i], bottoms[i] - tops[i]};
+  }
+
+  float const* left_data() const {
+    return lefts.data();
+  }
+
+  float const* top_data() const {
+    return tops.data();
+  }
+
+  float const* right_data() const {
+    return rights.data();
+  }
+
+  float const* bottom_data() const {
+    return bottoms.data();
+  }
+
+ private:
+  size_t count{0};
+  std::vector<float> lefts{};
+  std::vector<float> tops{};
+  std::vector<float> rights{};
+  std::vector<float> bottoms{};
+};
+
+size_t rect_batch_mask_words(size_t rect_count) {
+  return (rect_count + 63) / 64;
+}
+
+bool rect_batch_mask_test(std::vector<uint64_t> const& mask, size_t i) {
+  return (mask[i / 64] >> (i % 64)) & 1;
+}
+
+/**
+ * Sets bit `i` of `mask` when `rect` overlaps rectangle `i` of `batch`. Same semantics as `CheckCollisionRecs`: touching
+ * edges do not overlap. `mask` must hold `rect_batch_mask_words(batch.padded_size())` words.
+ */
+void overlap_one_to_many(Rectangle const& rect, RectBatch const& batch, uint64_t* mask) {
+  float const left = rect.x;
+  float const top = rect.y;
+  float const right = rect.x + rect.width;
+  float const bottom = rect.y + rect.height;
+
+  float const* lefts = batch.left_data();
+  float const* tops = batch.top_data();
+  float const* rights = batch.right_data();
+  float const* bottoms = batch.bottom_data();
+
+  for (size_t w = 0; w < rect_batch_mask_words(batch.padded_size()); w++) mask[w] = 0;
+
+#if defined(__AVX2__)
+  __m256 const v_left = _mm256_set1_ps(left);
+  __m256 const v_top = _mm256_set1_ps(top);
+  __m256 const v_right = _mm256_set1_ps(right);
+  __m256 const v_bottom = _mm256_set1_ps(bottom);
+
+  for (size_t i = 0; i < batch.padded_size(); i += 8) {
+    __m256 hit = _mm256_and_ps(_mm256_cmp_ps(v_left, _mm256_loadu_ps(rights + i), _CMP_LT_OQ),
+                               _mm256_cmp_ps(v_right, _mm256_loadu_ps(lefts + i), _CMP_GT_OQ));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(v_top, _mm256_loadu_ps(bottoms + i), _CMP_LT_OQ));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(v_bottom, _mm256_loadu_ps(tops + i), _CMP_GT_OQ));
+
+    uint64_t bits = static_cast<uint64_t>(_mm256_movemask_ps(hit));
+    if (bits) mask[i / 64] |= bits << (i % 64);
+  }
+#elif defined(__SSE2__)
+  __m128 const v_left = _mm_set1_ps(left);
+  __m128 const v_top = _mm_set1_ps(top);
+  __m128 const v_right = _mm_set1_ps(right);
+  __m128 const v_bottom = _mm_set1_ps(bottom);
+
+  for (size_t i = 0; i < batch.padded_size(); i += 4) {
+    __m128 hit = _mm_and_ps(_mm_cmplt_ps(v_left, _mm_loadu_ps(rights + i)),
+                            _mm_cmpgt_ps(v_right, _mm_loadu_ps(lefts + i)));
+    hit = _mm_and_ps(hit, _mm_cmplt_ps(v_top, _mm_loadu_ps(bottoms + i)));
+    hit = _mm_and_ps(hit, _mm_cmpgt_ps(v_bottom, _mm_loadu_ps(tops + i)));
+
+    uint64_t bits = static_cast<uint64_t>(_mm_movemask_ps(hit));
+    if (bits) mask[i / 64] |= bits << (i % 64);
+  }
+#else
+  for (size_t i = 0; i < batch.size(); i++) {
+    bool hit = left < rights[i] && right > lefts[i] && top < bottoms[i] && bottom > tops[i];
+    if (hit) mask[i / 64] |= uint64_t{1} << (i % 64);
+  }
+#endif
+}
+
+void overlap_one_to_many(Rectangle const& rect, RectBatch const& batch, std::vector<uint64_t>* mask) {
+  mask->resize(rect_batch_mask_words(batch.padded_size()));
+  overlap_one_to_many(rect, batch, mask->data());
+}
+
+/**
+ * Row `i` of `masks` (`rect_batch_mask_words(rhs.padded_size())` words each) holds the overlaps of `lhs[i]` with `rhs`.
+ */
+void overlap_many_to_many(RectBatch const& lhs, RectBatch const& rhs, std::vector<uint64_t>* masks) {
+  size_t const words = rect_batch_mask_words(rhs.padded_size());
+  masks->resize(lhs.size() * words);
+
+  for (size_t i = 0; i < lhs.size(); i++) overlap_one_to_many(lhs.get(i), rhs, masks->data() + i * words);
+}
+
+/**
+ * Calls `f(i)` for every set bit of `mask`, in increasing order.
+ */
+template <typename F>
+void for_each_mask_bit(std::vector<uint64_t> const& mask, size_t rect_count, F&& f) {
+  for (size_t w = 0; w < rect_batch_mask_words(rect_count); w++) {
+    uint64_t bits = mask[w];
+    while (bits) {
+      size_t i = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+      if (i >= rect_count) return;
+      f(i);
+      bits &= bits - 1;
+    }
+  }
+}
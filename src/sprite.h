@@ -1,11 +1,17 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 
+#include "animation.h"
 #include "common.h"
 #include "raylib.h"
 #include "raymath.h"
 
+/**
+ * Frames are derived from the global animation clock, which also keeps the playback state; the sprite holds the sheet
+ * and an index into the clock's tracks, so looping sprites need no per-frame update.
+ */
 struct Sprite {
  public:
   ~Sprite() {
@@ -17,7 +23,7 @@ struct Sprite {
         texture(std::move(texture)),
         size(size),
         frame_count(frame_count),
-        frame_stepper(frame_length) {
+        frame_length(std::max(frame_length, 1u)) {
   }
 
   void reset() {
@@ -26,37 +32,48 @@ struct Sprite {
   }
 
   void restart() {
-    frame_stepper.reset();
-    current_frame = 0;
+    *track = AnimationTrack{animation_clock.now(), 0, 0, 0, track->is_paused};
   }
 
   void init_texture(std::shared_ptr<Texture2D> new_texture, Vector2 new_size, int new_frame_count,
-                    unsigned int frame_length) {
+                    unsigned int new_frame_length) {
     texture = std::move(new_texture);
     size = new_size;
     frame_count = new_frame_count;
-    frame_stepper.set_threshold(frame_length);
+    frame_length = std::max(new_frame_length, 1u);
+    restart();
   }
 
   void draw(Vector2 const& pos) const {
-    DrawTexturePro(*texture, {size.x * current_frame, 0.f, size.x * horizontal_reverse, size.y},
+    DrawTexturePro(*texture, {size.x * current_frame(), 0.f, size.x * horizontal_reverse, size.y},
                    {pos.x - origin.x, pos.y - origin.y, size.x * pixel_size, size.y * pixel_size}, origin, 0.f, WHITE);
   }
 
   /**
-   * Returns a non negative integer when it's changed to a new sequence.
+   * Returns a non negative integer when it's changed to a new sequence since the last call. Only needed by owners
+   * reacting to a specific frame; the frame itself advances with the clock.
    */
   int update() {
-    if (paused) return -1;
-    if (frame_count == 1) return -1;
+    int frame = current_frame();
+    if (frame == track->last_frame) return -1;
 
-    if (frame_stepper.update()) {
-      current_frame = (current_frame + 1) % frame_count;
+    track->last_frame = static_cast<int16_t>(frame);
+    return frame;
+  }
 
-      return current_frame;
-    }
+  int current_frame() const {
+    return animation_clock.frame(track.get_index(), frame_count, frame_length);
+  }
 
-    return -1;
+  /**
+   * Plays the sequence from its first frame and notifies `listener` with `tag` once its last frame has been shown. The
+   * owner decides what happens next (usually `stop()`).
+   */
+  void play_once(AnimationListener* listener, int tag) {
+    restart();
+    track->is_paused = false;
+    track->end_tick = track->start_tick + frame_count * frame_length;
+    animation_clock.schedule(track->end_tick, listener, tag);
   }
 
   void set_pixel_size(float new_pixel_size) {
@@ -75,12 +92,26 @@ struct Sprite {
     return texture;
   }
 
+  /**
+   * Freezes the current frame. A finished one-shot sequence freezes on its first frame, however late the clock
+   * reported its end.
+   */
   void stop() {
-    paused = true;
+    if (track->is_paused) return;
+    int16_t frame = static_cast<int16_t>(current_frame());
+    track->paused_frame = frame;
+    track->end_tick = 0;
+    track->is_paused = true;
   }
 
   void play() {
-    paused = false;
+    if (!track->is_paused) return;
+    track->start_tick = animation_clock.now() - track->paused_frame * frame_length;
+    track->is_paused = false;
+  }
+
+  bool is_playing() const {
+    return !track->is_paused;
   }
 
  private:
@@ -88,9 +119,8 @@ struct Sprite {
   std::shared_ptr<Texture2D> texture;
   Vector2 size{};
   int frame_count{1};
-  Stepper frame_stepper{};
+  unsigned int frame_length{DEFAULT_FRAME_TICKS};
+  AnimationTrackHandle track{};
   Vector2 origin{0.f, 0.f};
-  int current_frame{0};
   int horizontal_reverse{1};
-  int paused{false};
 };
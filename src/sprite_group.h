@@ -1,58 +1,82 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
 
+#include "animation.h"
+#include "asset_manager.h"
+#include "common.h"
 #include "raylib.h"
-#include "sprite.h"
+#include "sprite_sheet.h"
 
+/**
+ * Plays one of the sheets of a shared animation prototype. Holds only the prototype id and an index into the
+ * clock's playback tracks.
+ */
 struct SpriteGroup {
  public:
+  SpriteGroup(AnimationPrototype prototype, float pixel_size) : pixel_size(pixel_size), prototype(prototype) {
+  }
+
   void reset() {
     horizontal_reset();
-    set_current_sprite(0);
+    current_sprite_index = 0;
+    restart();
   }
 
   void set_current_sprite(size_t new_current_sprite_index) {
-    if (new_current_sprite_index >= sprites.size()) {
+    if (new_current_sprite_index >= animation_prototype_sheets(prototype).size()) {
       TraceLog(LOG_ERROR, "Invalid sprite index");
       return;
     }
-    current_sprite_index = new_current_sprite_index;
+    if (new_current_sprite_index == current_sprite_index) return;
+
+    current_sprite_index = static_cast<uint8_t>(new_current_sprite_index);
+    restart();
   }
 
   void horizontal_flip() {
-    for (auto& sprite : sprites) sprite.horizontal_flip();
+    horizontal_reverse = -1;
   }
 
   void horizontal_reset() {
-    for (auto& sprite : sprites) sprite.horizontal_reset();
+    horizontal_reverse = 1;
   }
 
+  /**
+   * Returns a non negative integer when it's changed to a new sequence since the last call.
+   */
   int update() {
-    return current_sprite_mut().update();
-  }
+    int frame = current_frame();
+    if (frame == track->last_frame) return -1;
 
-  void draw(Vector2 const& pos) const {
-    current_sprite().draw(pos);
+    track->last_frame = static_cast<int16_t>(frame);
+    return frame;
   }
 
-  void push_sprite(Sprite&& sprite) {
-    sprites.push_back(std::move(sprite));
+  void draw(Vector2 const& pos) const {
+    SpriteSheet const& sheet = current_sheet();
+    DrawTexturePro(*asset_manager.textures[sheet.texture],
+                   {sheet.size.x * current_frame(), 0.f, sheet.size.x * horizontal_reverse, sheet.size.y},
+                   {pos.x, pos.y, sheet.size.x * pixel_size, sheet.size.y * pixel_size}, vector_zero, 0.f, WHITE);
   }
 
   void restart() {
-    current_sprite_mut().restart();
+    *track = AnimationTrack{animation_clock.now()};
   }
 
-  Sprite const& current_sprite() const {
-    return sprites[current_sprite_index];
+  SpriteSheet const& current_sheet() const {
+    return animation_prototype_sheets(prototype)[current_sprite_index];
   }
 
  private:
-  std::vector<Sprite> sprites{};
-  size_t current_sprite_index{0};
+  float pixel_size;
+  AnimationPrototype prototype;
+  uint8_t current_sprite_index{0};
+  int8_t horizontal_reverse{1};
+  AnimationTrackHandle track{};
 
-  Sprite& current_sprite_mut() {
-    return sprites[current_sprite_index];
+  int current_frame() const {
+    SpriteSheet const& sheet = current_sheet();
+    return animation_clock.frame(track.get_index(), sheet.frame_count, sheet.frame_length);
   }
 };
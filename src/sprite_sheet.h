@@ -0,0 +1,102 @@
+#pragma once
+
+#include <span>
+
+#include "animation.h"
+#include "asset_manager.h"
+#include "raylib.h"
+
+/**
+ * Immutable description of one horizontal frame strip. Shared by every instance of an entity kind.
+ */
+struct SpriteSheet {
+  TextureNames texture;
+  Vector2 size;
+  int frame_count;
+  unsigned int frame_length;
+};
+
+enum class AnimationPrototype {
+  Character1,
+  Enemy1,
+  Enemy2,
+  Enemy3,
+  Enemy4,
+  Enemy5,
+  BulletShort,
+};
+
+// Sheet order must match the sprite index constants of the owning entity.
+
+constexpr SpriteSheet const CHARACTER1_SHEETS[]{
+    {TextureNames::Character1__Run, {32.f, 32.f}, 12, DEFAULT_FRAME_TICKS},
+    {TextureNames::Character1__Idle, {32.f, 32.f}, 11, DEFAULT_FRAME_TICKS},
+    {TextureNames::Character1__Hit, {32.f, 32.f}, 7, DEFAULT_FRAME_TICKS},
+    {TextureNames::Character1__Jump, {32.f, 32.f}, 1, DEFAULT_FRAME_TICKS},
+    {TextureNames::Character1__Fall, {32.f, 32.f}, 1, DEFAULT_FRAME_TICKS},
+    {TextureNames::Character1__Double_Jump, {32.f, 32.f}, 6, DEFAULT_FRAME_TICKS},
+    {TextureNames::Character1__Wall_Jump, {32.f, 32.f}, 5, DEFAULT_FRAME_TICKS},
+};
+
+constexpr SpriteSheet const ENEMY1_SHEETS[]{
+    {TextureNames::Enemy1__Fall, {48.f, 48.f}, 3, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy1__Hit, {48.f, 48.f}, 5, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy1__Idle, {48.f, 48.f}, 11, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy1__Jump, {48.f, 48.f}, 3, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy1__Run, {48.f, 48.f}, 12, DEFAULT_FRAME_TICKS},
+};
+
+constexpr SpriteSheet const ENEMY2_SHEETS[]{
+    {TextureNames::Enemy2__Fall, {48.f, 48.f}, 1, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy2__Hit, {48.f, 48.f}, 5, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy2__Idle, {48.f, 48.f}, 11, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy2__Jump, {48.f, 48.f}, 1, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy2__Run, {48.f, 48.f}, 12, DEFAULT_FRAME_TICKS},
+};
+
+constexpr SpriteSheet const ENEMY3_SHEETS[]{
+    {TextureNames::Enemy3__Charge, {48.f, 48.f}, 12, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy3__Hit, {48.f, 48.f}, 5, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy3__Idle, {48.f, 48.f}, 11, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy3__Stun, {48.f, 48.f}, 8, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy3__Walk, {48.f, 48.f}, 12, DEFAULT_FRAME_TICKS},
+};
+
+constexpr SpriteSheet const ENEMY4_SHEETS[]{
+    {TextureNames::Enemy4__Attack, {48.f, 48.f}, 7, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy4__Hit, {48.f, 48.f}, 5, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy4__Idle, {48.f, 48.f}, 11, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy4__Walk, {48.f, 48.f}, 12, DEFAULT_FRAME_TICKS},
+};
+
+constexpr SpriteSheet const ENEMY5_SHEETS[]{
+    {TextureNames::Enemy5__Attack, {48.f, 48.f}, 8, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy5__Fly, {48.f, 48.f}, 6, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy5__Hit, {48.f, 48.f}, 5, DEFAULT_FRAME_TICKS},
+    {TextureNames::Enemy5__Idle, {48.f, 48.f}, 6, DEFAULT_FRAME_TICKS},
+};
+
+constexpr SpriteSheet const BULLET_SHORT_SHEETS[]{
+    {TextureNames::BulletShort, {10.f, 10.f}, 1, DEFAULT_FRAME_TICKS},
+};
+
+constexpr std::span<SpriteSheet const> animation_prototype_sheets(AnimationPrototype prototype) {
+  switch (prototype) {
+    case AnimationPrototype::Character1:
+      return CHARACTER1_SHEETS;
+    case AnimationPrototype::Enemy1:
+      return ENEMY1_SHEETS;
+    case AnimationPrototype::Enemy2:
+      return ENEMY2_SHEETS;
+    case AnimationPrototype::Enemy3:
+      return ENEMY3_SHEETS;
+    case AnimationPrototype::Enemy4:
+      return ENEMY4_SHEETS;
+    case AnimationPrototype::Enemy5:
+      return ENEMY5_SHEETS;
+    case AnimationPrototype::BulletShort:
+      return BULLET_SHORT_SHEETS;
+  }
+
+  return {};
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "file_util.h"
+#include "raylib.h"
+
+constexpr const char* TEXTURE_CACHE_DIR{"assets/cache"};
+constexpr uint32_t const TEXTURE_CACHE_MAGIC{0x58545550};  // "PUTX"
+constexpr uint32_t const TEXTURE_CACHE_VERSION{1};
+
+constexpr uint64_t const FNV1A_OFFSET_BASIS{14695981039346656037ull};
+constexpr uint64_t const FNV1A_PRIME{1099511628211ull};
+
+uint64_t fnv1a_hash(unsigned char const* data, size_t size, uint64_t hash = FNV1A_OFFSET_BASIS) {
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= FNV1A_PRIME;
+  }
+  return hash;
+}
+
+/**
+ * Cache file layout: this header, then `data_size` bytes of RGBA8 pixels.
+ */
+struct TextureCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  // Hash of the source image file, a mismatch means the source changed since caching.
+  uint64_t source_hash;
+  int32_t width;
+  int32_t height;
+  uint32_t data_size;
+  uint32_t padding;
+};
+
+// One cache file per source path, named by the path hash.
+std::string texture_cache_filename(char const* source_path) {
+  uint64_t path_hash = fnv1a_hash(reinterpret_cast<unsigned char const*>(source_path), std::strlen(source_path));
+
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.rgba", static_cast<unsigned long long>(path_hash));
+  return std::string{TEXTURE_CACHE_DIR} + "/" + name;
+}
+
+/**
+ * Uploads the cached pixels of a source file with hash `source_hash` straight from the mapped cache file. Returns a
+ * texture with id 0 if the cache is missing or stale.
+ */
+Texture2D load_texture_from_cache(std::string const& cache_filename, uint64_t source_hash) {
+  Texture2D texture{};
+
+  int fd = open(cache_filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return texture;
+
+  struct stat file_stat {};
+  if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(TextureCacheHeader)) {
+    close(fd);
+    return texture;
+  }
+
+  size_t file_size = static_cast<size_t>(file_stat.st_size);
+  void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return texture;
+
+  TextureCacheHeader header{};
+  std::memcpy(&header, mapped, sizeof(header));
+
+  bool is_valid = header.magic == TEXTURE_CACHE_MAGIC && header.version == TEXTURE_CACHE_VERSION &&
+                  header.source_hash == source_hash && header.width > 0 && header.height > 0 &&
+                  header.data_size == static_cast<uint32_t>(header.width) * static_cast<uint32_t>(header.height) * 4 &&
+                  file_size == sizeof(header) + header.data_size;
+
+  if (is_valid) {
+    Image image{static_cast<unsigned char*>(mapped) + sizeof(header), header.width, header.height, 1,
+                PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    texture = LoadTextureFromImage(image);
+  }
+
+  munmap(mapped, file_size);
+  return texture;
+}
+
+void write_texture_cache(std::string const& cache_filename, uint64_t source_hash, Image const& image) {
+  TextureCacheHeader header{TEXTURE_CACHE_MAGIC,
+                            TEXTURE_CACHE_VERSION,
+                            source_hash,
+                            image.width,
+                            image.height,
+                            static_cast<uint32_t>(image.width) * static_cast<uint32_t>(image.height) * 4,
+                            0};
+
+  std::vector<char> buffer(sizeof(header) + header.data_size);
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  std::memcpy(buffer.data() + sizeof(header), image.data, header.data_size);
+
+  std::error_code error{};
+  std::filesystem::create_directories(TEXTURE_CACHE_DIR, error);
+  write_file_atomically(cache_filename.c_str(), buffer);
+}
+
+/**
+ * Loads a texture through the pixel cache: a valid cache entry is uploaded without decoding, otherwise the source is
+ * decoded and the cache entry (re)written. Entries are validated by the hash of the source file content. `path` names
+ * the cache entry and the image type, `data` is the content of the source file.
+ */
+Texture2D load_texture_cached(char const* path, unsigned char const* data, int size) {
+  uint64_t source_hash = fnv1a_hash(data, static_cast<size_t>(size));
+  std::string cache_filename{texture_cache_filename(path)};
+
+  Texture2D texture = load_texture_from_cache(cache_filename, source_hash);
+  if (texture.id != 0) return texture;
+
+  Image image = LoadImageFromMemory(GetFileExtension(path), data, size);
+  if (!image.data) {
+    TraceLog(LOG_WARNING, "Cannot decode texture: %s", path);
+    return texture;
+  }
+
+  ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+  write_texture_cache(cache_filename, source_hash, image);
+
+  texture = LoadTextureFromImage(image);
+  UnloadImage(image);
+  return texture;
+}
+
+Texture2D load_texture_cached(char const* path) {
+  int file_size{0};
+  unsigned char* file_data = LoadFileData(path, &file_size);
+  if (!file_data) return LoadTexture(path);
+
+  Texture2D texture = load_texture_cached(path, file_data, file_size);
+  UnloadFileData(file_data);
+  return texture;
+}
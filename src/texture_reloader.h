@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asset_manager.h"
+#include "file_watcher.h"
+#include "raylib.h"
+
+struct DecodedTexture {
+  int name;
+  Image image;
+};
+
+/**
+ * Watches the texture files and reloads the ones rewritten on disk. PNG decoding runs on a worker thread, the GPU
+ * upload and the swap behind the existing handle happen in `update` on the main (GL) thread.
+ */
+struct TextureReloader {
+ public:
+  TextureReloader() : worker([this]() { run(); }) {
+  }
+
+  ~TextureReloader() {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      should_stop = true;
+    }
+    has_work.notify_one();
+    worker.join();
+
+    for (auto& decoded : decoded_textures) UnloadImage(decoded.image);
+  }
+
+  TextureReloader(TextureReloader const&) = delete;
+  TextureReloader& operator=(TextureReloader const&) = delete;
+
+  void watch_all() {
+    for (char const* path : TEXTURE_PATHS) watcher.watch(path);
+  }
+
+  /**
+   * Queues changed files for decoding and swaps in the ones already decoded. Returns whether any texture changed.
+   */
+  bool update() {
+    changed_paths.clear();
+    watcher.poll(&changed_paths);
+
+    if (!changed_paths.empty()) {
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto const& path : changed_paths) {
+          int name = texture_name_of(path);
+          if (name < 0 || !asset_manager.is_resident(name)) continue;
+          if (std::find(pending_names.begin(), pending_names.end(), name) == pending_names.end()) {
+            pending_names.push_back(name);
+          }
+        }
+      }
+      has_work.notify_one();
+    }
+
+    ready_textures.clear();
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (decoded_textures.empty()) return false;
+      std::swap(ready_textures, decoded_textures);
+    }
+
+    for (auto& decoded : ready_textures) {
+      asset_manager.replace_texture(decoded.name, decoded.image);
+      UnloadImage(decoded.image);
+    }
+    return true;
+  }
+
+ private:
+  FileWatcher watcher{};
+  std::vector<std::string> changed_paths{};
+  std::vector<DecodedTexture> ready_textures{};
+
+  std::mutex mutex{};
+  std::condition_variable has_work{};
+  std::vector<int> pending_names{};
+  std::vector<DecodedTexture> decoded_textures{};
+  bool should_stop{false};
+
+  // Last member, the thread must start after the state above is initialized.
+  std::thread worker;
+
+  static int texture_name_of(std::string const& path) {
+    for (int i = 0; i < TextureNames__Count; i++) {
+      if (path == TEXTURE_PATHS[i]) return i;
+    }
+    return -1;
+  }
+
+  void run() {
+    while (true) {
+      int name;
+      {
+        std::unique_lock<std::mutex> lock{mutex};
+        has_work.wait(lock, [this]() { return should_stop || !pending_names.empty(); });
+        if (should_stop) return;
+
+        name = pending_names.front();
+        pending_names.erase(pending_names.begin());
+      }
+
+      Image image = LoadImage(TEXTURE_PATHS[name]);
+      if (image.data == nullptr) {
+        // Most likely caught mid-write, the closing write triggers another reload.
+        TraceLog(LOG_WARNING, "Cannot decode texture: %s", TEXTURE_PATHS[name]);
+        continue;
+      }
+
+      std::lock_guard<std::mutex> lock{mutex};
+      // A newer decode of the same file wins.
+      auto it = std::find_if(decoded_textures.begin(), decoded_textures.end(),
+                             [name](DecodedTexture const& decoded) { return decoded.name == name; });
+      if (it != decoded_textures.end()) {
+        UnloadImage(it->image);
+        it->image = image;
+      } else {
+        decoded_textures.push_back(DecodedTexture{name, image});
+      }
+    }
+  }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "arena.h"
+#include "common.h"
+#include "npc.h"
+#include "raylib.h"
+#include "trap.h"
+
+using NpcFactory = Npc* (*)(Arena* arena, IntVec2 const tile_pos, TileSource const tile_source, int const pixel_size);
+using TrapFactory = Trap* (*)(Arena* arena, IntVec2 const tile_pos, int const pixel_size);
+
+/**
+ * Constructors of the app owned tile kinds (`TileClass::Npc` and `TileClass::Trap`). Kept apart from `TILE_KINDS`
+ * because the entity types are not known in `common.h`.
+ */
+struct TileFactory {
+  TileSource source;
+  NpcFactory make_npc;
+  TrapFactory make_trap;
+};
+
+template <typename T>
+Npc* make_npc_at(Arena* arena, IntVec2 const tile_pos, TileSource const, int const pixel_size) {
+  return arena->make<T>(tile_pos.scale(pixel_size).to_vector2(), pixel_size);
+}
+
+Npc* make_simple_walk_npc(Arena* arena, IntVec2 const tile_pos, TileSource const tile_source, int const pixel_size) {
+  return arena->make<SimpleWalkNpc>(tile_pos, tile_source, pixel_size);
+}
+
+template <typename T>
+Trap* make_trap_at(Arena* arena, IntVec2 const tile_pos, int const pixel_size) {
+  return arena->make<T>(tile_pos.scale(pixel_size).to_vector2(), pixel_size);
+}
+
+// Indexed by `TileSource` like `TILE_KINDS`.
+constexpr TileFactory const TILE_FACTORIES[TILE_SOURCE_COUNT]{
+    {TileSource::Gui, nullptr, nullptr},
+    {TileSource::Tileset, nullptr, nullptr},
+    {TileSource::Box1, nullptr, nullptr},
+    {TileSource::Box2, nullptr, nullptr},
+    {TileSource::Box3, nullptr, nullptr},
+    {TileSource::Enemy1, make_simple_walk_npc, nullptr},
+    {TileSource::Enemy2, make_simple_walk_npc, nullptr},
+    {TileSource::Enemy3, make_npc_at<ChargingNpc>, nullptr},
+    {TileSource::Enemy4, make_npc_at<ShootingNpc>, nullptr},
+    {TileSource::Enemy5, make_npc_at<StompingNpc>, nullptr},
+    {TileSource::Trap1, nullptr, make_trap_at<BouncingTrap>},
+    {TileSource::Trap2, nullptr, make_trap_at<CircleSawTrap>},
+    {TileSource::Trap4, nullptr, make_trap_at<SpikeTrap>},
+    {TileSource::Trap5, nullptr, nullptr},
+    {TileSource::Trap6, nullptr, make_trap_at<ShockTowerTrap>},
+    {TileSource::End, nullptr, make_trap_at<EndCheckpoint>},
+};
+
+constexpr bool is_tile_factories_consistent() {
+  for (int i = 0; i < TILE_SOURCE_COUNT; i++) {
+    TileFactory const& factory = TILE_FACTORIES[i];
+    if (static_cast<int>(factory.source) != i) return false;
+    if ((factory.make_npc != nullptr) != (TILE_KINDS[i].tile_class == TileClass::Npc)) return false;
+    if ((factory.make_trap != nullptr) != (TILE_KINDS[i].tile_class == TileClass::Trap)) return false;
+  }
+  return true;
+}
+
+static_assert(is_tile_factories_consistent(), "TILE_FACTORIES rows must follow TileSource and match TILE_KINDS");
+
+constexpr TileFactory const& tile_factory(TileSource const tile_source) {
+  return TILE_FACTORIES[static_cast<int>(tile_source)];
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "animation.h"
 #include "character.h"
 #include "common.h"
 #include "raylib.h"
@@ -7,17 +8,29 @@
 struct Trap {
  public:
   virtual void draw() const = 0;
-  virtual void update(Map const& map, Character& character) = 0;
+  virtual void update(Map const& map) = 0;
+  // Called after `update` when the hitbox overlaps the character.
+  virtual void interact(Character& character) = 0;
   virtual Rectangle hitbox() const = 0;
+  virtual void reset() = 0;
+  // Whether touching the trap finished the level.
+  virtual bool is_level_completed() const {
+    return false;
+  }
 
   virtual ~Trap() = default;
 };
 
-struct BouncingTrap : Trap {
+struct BouncingTrap : Trap, AnimationListener {
  public:
   BouncingTrap(Vector2 pos, int const pixel_size) : pos(pos), pixel_size(pixel_size), sprite(pixel_size) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-    sprite.init_texture(asset_manager.textures[TextureNames::Trap1], SIMPLE_WALK_NPC_SIZE, 7, sprite_frame_length);
+    sprite.init_texture(asset_manager.textures[TextureNames::Trap1], SIMPLE_WALK_NPC_SIZE, 7, DEFAULT_FRAME_TICKS);
+    reset();
+  }
+
+  void reset() override {
+    animation_clock.cancel(this);
+    sprite.reset();
     sprite.stop();
   }
 
@@ -26,21 +39,27 @@ struct BouncingTrap : Trap {
     // DrawRectangleLinesEx(hitbox(), pixel_size, RED);
   }
 
-  virtual void update(Map const& map, Character& character) override {
-    if (sprite.update() == 0) sprite.stop();
+  virtual void update(Map const& map) override {
+  }
 
-    if (character.is_falling() && CheckCollisionRecs(hitbox(), character.hitbox())) {
+  virtual void interact(Character& character) override {
+    if (character.is_falling()) {
       character.bouncing_trap_interact();
-      sprite.reset();
-      sprite.play();
+      sprite.play_once(this, 0);
     }
   }
 
+  void on_animation_end(int tag) override {
+    sprite.stop();
+  }
+
   virtual Rectangle hitbox() const override {
     return move(upscale(tile_source_hitbox(TileSource::Trap1), pixel_size), pos);
   }
 
-  virtual ~BouncingTrap() = default;
+  virtual ~BouncingTrap() {
+    animation_clock.cancel(this);
+  }
 
  private:
   Vector2 pos;
@@ -51,8 +70,11 @@ struct BouncingTrap : Trap {
 struct CircleSawTrap : Trap {
  public:
   CircleSawTrap(Vector2 pos, int const pixel_size) : pos(pos), pixel_size(pixel_size), sprite(pixel_size) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-    sprite.init_texture(asset_manager.textures[TextureNames::Trap2], SIMPLE_WALK_NPC_SIZE, 7, sprite_frame_length);
+    sprite.init_texture(asset_manager.textures[TextureNames::Trap2], SIMPLE_WALK_NPC_SIZE, 7, DEFAULT_FRAME_TICKS);
+  }
+
+  void reset() override {
+    sprite.reset();
   }
 
   void draw() const override {
@@ -60,12 +82,11 @@ struct CircleSawTrap : Trap {
     // DrawRectangleLinesEx(hitbox(), pixel_size, RED);
   }
 
-  virtual void update(Map const& map, Character& character) override {
-    sprite.update();
+  virtual void update(Map const& map) override {
+  }
 
-    if (CheckCollisionRecs(hitbox(), character.hitbox())) {
-      character.injure(true);
-    }
+  virtual void interact(Character& character) override {
+    character.injure(true);
   }
 
   virtual Rectangle hitbox() const override {
@@ -80,11 +101,17 @@ struct CircleSawTrap : Trap {
   Sprite sprite;
 };
 
-struct SpikeTrap : Trap {
+struct SpikeTrap : Trap, AnimationListener {
  public:
   SpikeTrap(Vector2 pos, int const pixel_size) : pos(pos), pixel_size(pixel_size), sprite(pixel_size) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-    sprite.init_texture(asset_manager.textures[TextureNames::Trap4], SIMPLE_WALK_NPC_SIZE, 7, sprite_frame_length);
+    sprite.init_texture(asset_manager.textures[TextureNames::Trap4], SIMPLE_WALK_NPC_SIZE, 7, DEFAULT_FRAME_TICKS);
+  }
+
+  void reset() override {
+    sprite.reset();
+    sprite.play_once(this, 0);
+    timer.reset();
+    is_hidden = false;
   }
 
   void draw() const override {
@@ -92,21 +119,21 @@ struct SpikeTrap : Trap {
     // DrawRectangleLinesEx(hitbox(), pixel_size, RED);
   }
 
-  virtual void update(Map const& map, Character& character) override {
-    if (!is_hidden && sprite.update() == 0) {
-      sprite.stop();
-      timer.reset();
-      is_hidden = true;
-    }
-
+  virtual void update(Map const& map) override {
     if (is_hidden && timer.update()) {
-      sprite.play();
+      sprite.play_once(this, 0);
       is_hidden = false;
     }
+  }
 
-    if (CheckCollisionRecs(hitbox(), character.hitbox())) {
-      character.injure(true);
-    }
+  void on_animation_end(int tag) override {
+    sprite.stop();
+    timer.reset();
+    is_hidden = true;
+  }
+
+  virtual void interact(Character& character) override {
+    character.injure(true);
   }
 
   virtual Rectangle hitbox() const override {
@@ -117,7 +144,9 @@ struct SpikeTrap : Trap {
     }
   }
 
-  virtual ~SpikeTrap() = default;
+  virtual ~SpikeTrap() {
+    animation_clock.cancel(this);
+  }
 
  private:
   Vector2 pos;
@@ -127,11 +156,15 @@ struct SpikeTrap : Trap {
   bool is_hidden{false};
 };
 
-struct ShockTowerTrap : Trap {
+struct ShockTowerTrap : Trap, AnimationListener {
  public:
   ShockTowerTrap(Vector2 pos, int const pixel_size) : pos(pos), pixel_size(pixel_size), sprite(pixel_size) {
-    unsigned int sprite_frame_length = static_cast<unsigned int>(GameFPS / 24);
-    sprite.init_texture(asset_manager.textures[TextureNames::Trap6], SIMPLE_WALK_NPC_SIZE, 7, sprite_frame_length);
+    sprite.init_texture(asset_manager.textures[TextureNames::Trap6], SIMPLE_WALK_NPC_SIZE, 7, DEFAULT_FRAME_TICKS);
+  }
+
+  void reset() override {
+    sprite.reset();
+    sprite.play_once(this, 0);
   }
 
   void draw() const override {
@@ -139,25 +172,86 @@ struct ShockTowerTrap : Trap {
     // DrawRectangleLinesEx(hitbox(), pixel_size, RED);
   }
 
-  virtual void update(Map const& map, Character& character) override {
-    if (sprite.update() == 0) {
-      sprite.stop();
-    }
+  virtual void update(Map const& map) override {
+  }
 
-    if (CheckCollisionRecs(hitbox(), character.hitbox())) {
-      character.injure(true);
-      sprite.play();
-    }
+  virtual void interact(Character& character) override {
+    character.injure(true);
+    if (!sprite.is_playing()) sprite.play_once(this, 0);
+  }
+
+  void on_animation_end(int tag) override {
+    sprite.stop();
   }
 
   virtual Rectangle hitbox() const override {
     return move(upscale(tile_source_hitbox(TileSource::Trap6), pixel_size), pos);
   }
 
-  virtual ~ShockTowerTrap() = default;
+  virtual ~ShockTowerTrap() {
+    animation_clock.cancel(this);
+  }
+
+ private:
+  Vector2 pos;
+  int const pixel_size;
+  Sprite sprite;
+};
+
+/**
+ * End of the level. Touching it plays the pressed animation, the level is completed when that ends.
+ */
+struct EndCheckpoint : Trap, AnimationListener {
+ public:
+  EndCheckpoint(Vector2 pos, int const pixel_size) : pos(pos), pixel_size(pixel_size), sprite(pixel_size) {
+    reset();
+  }
+
+  void reset() override {
+    animation_clock.cancel(this);
+    sprite.init_texture(asset_manager.textures[TextureNames::End__Idle], END_CHECKPOINT_SIZE, 7, DEFAULT_FRAME_TICKS);
+    is_pressed = false;
+    is_completed = false;
+  }
+
+  void draw() const override {
+    sprite.draw(pos);
+    // DrawRectangleLinesEx(hitbox(), pixel_size, RED);
+  }
+
+  virtual void update(Map const& map) override {
+  }
+
+  virtual void interact(Character& character) override {
+    if (is_pressed || !character.is_live()) return;
+
+    is_pressed = true;
+    sprite.init_texture(asset_manager.textures[TextureNames::End__Pressed], END_CHECKPOINT_SIZE, 7,
+                        DEFAULT_FRAME_TICKS);
+    sprite.play_once(this, 0);
+  }
+
+  void on_animation_end(int tag) override {
+    sprite.stop();
+    is_completed = true;
+  }
+
+  virtual Rectangle hitbox() const override {
+    return move(upscale(tile_source_hitbox(TileSource::End), pixel_size), pos);
+  }
+
+  bool is_level_completed() const override {
+    return is_completed;
+  }
+
+  virtual ~EndCheckpoint() {
+    animation_clock.cancel(this);
+  }
 
  private:
   Vector2 pos;
   int const pixel_size;
   Sprite sprite;
+  bool is_pressed{false};
+  bool is_completed{false};
 };